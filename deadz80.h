@@ -7,9 +7,19 @@
 
 #define BAD_OPCODE		0x80000000
 
+//define DEADZ80_DOCUMENTED_FLAGS_ONLY to build only the core that skips the
+//undocumented x/y flag bits, otherwise docflags selects it per context
+
 typedef unsigned char u8;
 typedef unsigned short u16;
 typedef unsigned int u32;
+typedef unsigned long long u64;
+
+#if defined(_MSC_VER)
+#define DEADZ80_ALIGN(n)	__declspec(align(n))
+#else
+#define DEADZ80_ALIGN(n)	__attribute__((aligned(n)))
+#endif
 
 typedef u8 (*irqfunc_t)(u8);
 typedef u8 (*readfunc_t)(u32);
@@ -34,12 +44,21 @@ typedef struct z80regs_s {
         } hl;
 } z80regs_t;
 
-typedef struct deadz80_s {
-	char			tag[8];
-	z80regs_t	main, alt;				//register sets
-	z80regs_t	*regs;					//pointer to active register set
+//one entry of the memory map.  pages with a memory pointer are accessed
+//directly, the others go through the callback.  16 bytes on 64 bit hosts.
+typedef struct z80page_s {
+	u8				*ptr;						//page memory, 0 to use the callback
+	union {
+		readfunc_t	read;
+		writefunc_t	write;
+	} func;
+} z80page_t;
+
+//the context is cache line aligned, with everything the core touches on
+//every instruction packed into the first line
+typedef struct DEADZ80_ALIGN(64) deadz80_s {
 	u16			pc, sp;					//program counter, stack pointer
-	u8				i, r;
+	z80regs_t	main;						//active register set
 
 	union {
 		struct {
@@ -48,28 +67,39 @@ typedef struct deadz80_s {
 		u16 w;
 	} ix, iy;								//index registers
 
-	u8				iff1,iff2;
-	u8				imfa,imfb;
-
 	u32			cycles;					//cycle counter
+	u32			m1;						//m1 (opcode fetch) cycle counter
 
-	u8				*readpages[Z80_NUMPAGES];
-	u8				*writepages[Z80_NUMPAGES];
-	readfunc_t	readfuncs[Z80_NUMPAGES], ioreadfunc;
-	writefunc_t	writefuncs[Z80_NUMPAGES], iowritefunc;
-	irqfunc_t	irqfunc;
-
-	u8				opcode, opcode2;		//opcodes currently being executed
+	u8				opcode;					//opcode currently being executed
 	u8				nmistate, irqstate;	//states of the nmi/irq lines
 	u8				halt;						//cpu is halted indicator
+	u8				iff1,iff2;
 	u8				intmode, insideirq;
+	u8				docflags;				//skip undocumented x/y flags (zexdoc still passes)
+	u8				i, rbase;				//r is rbase plus m1, see deadz80_get_r()
 
+	//memory map, starts on the second cache line
+	DEADZ80_ALIGN(64) z80page_t readpages[Z80_NUMPAGES];
+	z80page_t	writepages[Z80_NUMPAGES];
+
+	//rarely used state
+	z80regs_t	alt;						//alternate register set, swapped in by exx/ex af,af'
+	readfunc_t	ioreadfunc;
+	writefunc_t	iowritefunc;
+	irqfunc_t	irqfunc;
+	struct deadz80_profile_s *profile;	//attached profiler, runs the instrumented core
+	struct deadz80_trace_s *trace;		//attached trace ring, runs the instrumented core
+	u8				opcode2;
+	u8				imfa,imfb;
+	char			tag[8];
 } deadz80_t;
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 	void deadz80_init();
+	deadz80_t *deadz80_new();
+	void deadz80_delete(deadz80_t *z);
 	void deadz80_setcontext(deadz80_t *z);
 	deadz80_t *deadz80_getcontext();
 	void deadz80_reset();
@@ -79,6 +109,9 @@ extern "C" {
 	void deadz80_clear_nmi(u8 state);
 	void deadz80_set_irq(u8 state);
 	void deadz80_clear_irq(u8 state);
+	u8 deadz80_get_r();
+	void deadz80_set_r(u8 r);
+	u8 deadz80_peek(u32 addr);
 	void deadz80_step();
 	u32 deadz80_execute(u32 cycles);
 	u32 deadz80_disassemble(char *dest, u32 p);
@@ -39,6 +39,10 @@
 	if((v) >= 0x10000)		\
 		F |= FLAG_C;
 
+//undocumented x/y flags of the block instructions come from bits 3 and 1
+#define BLOCKXY(v)	\
+	F |= (((v) & FLAG_X) | (((v) << 4) & FLAG_Y)) & FLAGS_XY;
+
 //some opcode helper macros
 #define OP_OUT(l,h,v)	\
 	if(z80->iowritefunc) \
@@ -50,9 +54,7 @@
 
 #define ADD(v)					\
 	stmp = A + v;			\
-	F &= ~(FLAG_S | FLAG_Z | FLAG_C | FLAG_V | FLAG_N | FLAG_H);			\
-	F |= (stmp) & 0x28;				\
-	F = stmp & 0x28;	\
+	F = stmp & FLAGS_XY;	\
 	checkSZ(stmp & 0xFF);		\
 	checkC(stmp);				\
 	checkV(A,v,stmp);		\
@@ -63,7 +65,7 @@
 #define ADC(v)					\
 	stmp = A + v + (F & 1);	\
 	otmp = (A & 0xF) + (v & 0xF) + (F & 1); \
-	F = stmp & 0x28;			\
+	F = stmp & FLAGS_XY;			\
 	if((otmp) >= 0x10)	\
 		F |= FLAG_H;		\
 	checkSZ(stmp & 0xFF);		\
@@ -73,7 +75,7 @@
 
 #define ADC16(v1,v2)					\
 	ltmp = v1 + v2 + (F & 1);	\
-	F = (ltmp >> 8) & 0x28;				\
+	F = (ltmp >> 8) & FLAGS_XY;				\
 	checkSZ16(ltmp & 0xFFFF);		\
 	checkC16(ltmp);				\
 	checkV16(v1,v2,ltmp);		\
@@ -83,27 +85,27 @@
 
 #define AND(v)		\
 	A &= v;			\
-	F = A & 0x28;	\
+	F = A & FLAGS_XY;	\
 	setH();			\
 	checkSZ(A);		\
 	checkP(A);
 
 #define XOR(v)		\
 	A ^= v;			\
-	F = A & 0x28;	\
+	F = A & FLAGS_XY;	\
 	checkSZ(A);		\
 	checkP(A);
 
 #define OR(v)		\
 	A |= v;			\
-	F = A & 0x28;	\
+	F = A & FLAGS_XY;	\
 	checkSZ(A);		\
 	checkP(A);
 
 #define DEC(r)							\
 	stmp = r - 1;						\
-	F &= ~(FLAG_S | FLAG_Z | FLAG_V | FLAG_H | 0x28);	\
-	F |= FLAG_N | (stmp & 0x28);		\
+	F &= ~(FLAG_S | FLAG_Z | FLAG_V | FLAG_H | FLAGS_XY);	\
+	F |= FLAG_N | (stmp & FLAGS_XY);		\
 	checkSZ(stmp & 0xFF);				\
 	checkV(stmp,1,r);					\
 	if((r & 0xF) < (1 & 0xF))			\
@@ -112,8 +114,8 @@
 
 #define INC(r)	\
 	stmp = r + 1;			\
-	F &= ~(FLAG_S | FLAG_Z | FLAG_V | FLAG_N | FLAG_H | 0x28);	\
-	F |= stmp & 0x28;		\
+	F &= ~(FLAG_S | FLAG_Z | FLAG_V | FLAG_N | FLAG_H | FLAGS_XY);	\
+	F |= stmp & FLAGS_XY;		\
 	checkSZ(stmp & 0xFF);	\
 	checkV(r,1,stmp);		\
 	if((r & 0xF) == 0xF) \
@@ -123,7 +125,7 @@
 #define CP(n)	\
 	stmp = A - n;				\
 	F &= ~(FLAG_S | FLAG_Z | FLAG_C | FLAG_V | FLAG_N | FLAG_H);	\
-	F = (n & 0x28) | FLAG_N;				\
+	F = (n & FLAGS_XY) | FLAG_N;				\
 	checkSZ(stmp & 0xFF);			\
 	checkC(stmp);					\
 	checkV(stmp,n,A);			\
@@ -133,13 +135,13 @@
 #define BIT(b,r)			\
 tmp = (1 << b) & r;		\
 F &= FLAG_C; \
-F |= (r & 0x28) | FLAG_H;		\
+F |= (r & FLAGS_XY) | FLAG_H;		\
 F |= (tmp ? 0 : FLAG_Z | FLAG_P) | (tmp & FLAG_S);
 
 #define BIT_HL(b,r)			\
 tmp = (1 << b) & r;		\
 F &= FLAG_C; \
-F |= (HL & 0x28) | FLAG_H;		\
+F |= (HL & FLAGS_XY) | FLAG_H;		\
 F |= (tmp ? 0 : FLAG_Z | FLAG_P) | (tmp & FLAG_S);
 
 #define SET(b,r)			\
@@ -151,8 +153,8 @@ F |= (tmp ? 0 : FLAG_Z | FLAG_P) | (tmp & FLAG_S);
 #define SUB(n)						\
 	tmp = n;						\
 	stmp = A - tmp;					\
-	F &= ~(FLAG_S | FLAG_Z | FLAG_C | FLAG_V | FLAG_H | 0x28);	\
-	F |= stmp & 0x28;	\
+	F &= ~(FLAG_S | FLAG_Z | FLAG_C | FLAG_V | FLAG_H | FLAGS_XY);	\
+	F |= stmp & FLAGS_XY;	\
 	checkSZ(stmp & 0xFF);			\
 	checkC(stmp);					\
 	checkV(stmp,tmp,A);				\
@@ -165,7 +167,7 @@ F |= (tmp ? 0 : FLAG_Z | FLAG_P) | (tmp & FLAG_S);
 	tmp = n;						\
 	stmp = A - tmp - (F & 1);		\
 	F = FLAG_N | ((A ^ (n) ^ stmp) & FLAG_H);		\
-	F |= stmp & 0x28;				\
+	F |= stmp & FLAGS_XY;				\
 	checkSZ(stmp & 0xFF);			\
 	checkC(stmp);					\
 	checkV(stmp,tmp,A);				\
@@ -174,8 +176,8 @@ F |= (tmp ? 0 : FLAG_Z | FLAG_P) | (tmp & FLAG_S);
 #define SBC16(n1,n2)				\
 	stmp = n2;						\
 	ltmp = n1 - stmp - (F & 1);		\
-	F &= ~(FLAG_S | FLAG_Z | FLAG_C | FLAG_V | FLAG_H | 0x28);	\
-	F |= (ltmp >> 8) & 0x28;				\
+	F &= ~(FLAG_S | FLAG_Z | FLAG_C | FLAG_V | FLAG_H | FLAGS_XY);	\
+	F |= (ltmp >> 8) & FLAGS_XY;				\
 	checkSZ16(ltmp & 0xFFFF);			\
 	checkC16(ltmp);					\
 	checkV16(ltmp,stmp,n1);				\
@@ -184,6 +186,11 @@ F |= (tmp ? 0 : FLAG_Z | FLAG_P) | (tmp & FLAG_S);
 	n1 = (u16)ltmp;					\
 	F |= FLAG_N;
 
+#define LD_A_IR(v)		\
+	A = v;				\
+	F = (F & FLAG_C) | (A & FLAGS_XY) | (IFF2 ? FLAG_P : 0);	\
+	checkSZ(A);
+
 #define RET(c)			\
 	if(c) {				\
 		PC = read8(SP+0) | (read8(SP+1) << 8);	\
@@ -234,8 +241,8 @@ F |= (tmp ? 0 : FLAG_Z | FLAG_P) | (tmp & FLAG_S);
 
 #define ADD16(a1,a2)	\
 	ltmp = a1 + a2;				\
-	F &= ~(FLAG_C | FLAG_N | FLAG_H | 0x28);	\
-	F |= (ltmp >> 8) & 0x28;					\
+	F &= ~(FLAG_C | FLAG_N | FLAG_H | FLAGS_XY);	\
+	F |= (ltmp >> 8) & FLAGS_XY;					\
 	checkC16(ltmp);								\
 	if(((a1 & 0xFFF) + (a2 & 0xFFF)) >= 0x1000)	\
 		F |= FLAG_H;					\
@@ -257,12 +264,12 @@ F |= (tmp ? 0 : FLAG_Z | FLAG_P) | (tmp & FLAG_S);
 	SP += 2;
 
 #define EXX()	\
-	utmp[0] = z80->regs->bc.w;	\
-	utmp[1] = z80->regs->de.w;	\
-	utmp[2] = z80->regs->hl.w;	\
-	z80->regs->bc.w = z80->alt.bc.w;	\
-	z80->regs->de.w = z80->alt.de.w;	\
-	z80->regs->hl.w = z80->alt.hl.w;	\
+	utmp[0] = z80->main.bc.w;	\
+	utmp[1] = z80->main.de.w;	\
+	utmp[2] = z80->main.hl.w;	\
+	z80->main.bc.w = z80->alt.bc.w;	\
+	z80->main.de.w = z80->alt.de.w;	\
+	z80->main.hl.w = z80->alt.hl.w;	\
 	z80->alt.bc.w = utmp[0];	\
 	z80->alt.de.w = utmp[1];	\
 	z80->alt.hl.w = utmp[2];	\
@@ -276,14 +283,14 @@ F |= (tmp ? 0 : FLAG_Z | FLAG_P) | (tmp & FLAG_S);
 
 #define RLC(d)						\
 	d = (d << 1) | (d >> 7);		\
-	F = (d & FLAG_C) | (d & 0x28);	\
+	F = (d & FLAG_C) | (d & FLAGS_XY);	\
 	checkSZ(d);						\
 	checkP(d);
 
 #define RRC(d)					\
 	F = d & FLAG_C;				\
 	d = (d >> 1) | (d << 7);	\
-	F |= d & 0x28;				\
+	F |= d & FLAGS_XY;				\
 	checkSZ(d);					\
 	checkP(d);
 
@@ -291,54 +298,54 @@ F |= (tmp ? 0 : FLAG_Z | FLAG_P) | (tmp & FLAG_S);
 	tmp = (A >> 7) & 1;		\
 	A = (A << 1) | (F & FLAG_C);\
 	F &= (FLAG_S | FLAG_Z | FLAG_P);		\
-	F |= tmp | (A & 0x28);
+	F |= tmp | (A & FLAGS_XY);
 
 #define RL(d)					\
 	tmp = (d >> 7) & 1;		\
 	d = (d << 1) | (F & FLAG_C);\
-	F = (d & 0x28) | tmp;		\
+	F = (d & FLAGS_XY) | tmp;		\
 	checkSZ(d);					\
 	checkP(d);
 
 #define RR(d)					\
 	tmp = d & 1;				\
 	d = (d >> 1) | ((F & FLAG_C) << 7);\
-	F = (d & 0x28) | tmp;		\
+	F = (d & FLAGS_XY) | tmp;		\
 	checkSZ(d);					\
 	checkP(d);
 
 #define SLA(d)					\
 	F = d >> 7;					\
 	d = d << 1;					\
-	F |= (d & 0x28);			\
+	F |= (d & FLAGS_XY);			\
 	checkSZ(d);					\
 	checkP(d);
 
 #define SRA(d)					\
 	F = d & 1;					\
 	d = (d >> 1) | (d & 0x80);	\
-	F |= (d & 0x28);			\
+	F |= (d & FLAGS_XY);			\
 	checkSZ(d);					\
 	checkP(d);
 
 #define SLL(d)					\
 	F = d >> 7;					\
 	d = (d << 1) | 1;			\
-	F |= (d & 0x28);			\
+	F |= (d & FLAGS_XY);			\
 	checkSZ(d);					\
 	checkP(d);
 
 #define SRL(d)					\
 	F = d & 1;					\
 	d = d >> 1;					\
-	F |= (d & 0x28);			\
+	F |= (d & FLAGS_XY);			\
 	checkSZ(d);					\
 	checkP(d);
 
 #define BIT_IDX(b)	\
 tmp = (1 << b) & read8(ltmp);		\
 F &= FLAG_C; \
-F |= ((ltmp >> 8) & 0x28) | FLAG_H;		\
+F |= ((ltmp >> 8) & FLAGS_XY) | FLAG_H;		\
 F |= (tmp ? 0 : FLAG_Z | FLAG_P) | (tmp & FLAG_S); \
 	CYCLES += 20;
 
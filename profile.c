@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "profile.h"
+
+//find (or add) the calling context tree node for addr called from parent
+static u32 node_find(deadz80_profile_t *p, u32 parent, u16 addr)
+{
+	u32 hash = (parent * 31 + addr) & 4095;
+	u32 n;
+
+	for (n = p->buckets[hash]; n; n = p->nodes[n].next) {
+		if (p->nodes[n].parent == parent && p->nodes[n].addr == addr)
+			return(n);
+	}
+
+	if (p->numnodes == p->maxnodes) {
+		profnode_t *nodes = (profnode_t*)realloc(p->nodes, sizeof(profnode_t) * p->maxnodes * 2);
+
+		//out of memory, charge the callee to its caller
+		if (nodes == 0)
+			return(parent);
+		p->nodes = nodes;
+		p->maxnodes *= 2;
+	}
+
+	n = p->numnodes++;
+	p->nodes[n].parent = parent;
+	p->nodes[n].addr = addr;
+	p->nodes[n].cycles = 0;
+	p->nodes[n].next = p->buckets[hash];
+	p->buckets[hash] = n;
+	return(n);
+}
+
+deadz80_profile_t *deadz80_profile_create()
+{
+	deadz80_profile_t *p;
+
+	if ((p = (deadz80_profile_t*)malloc(sizeof(deadz80_profile_t))) == 0)
+		return(0);
+	p->maxnodes = 1024;
+	if ((p->nodes = (profnode_t*)malloc(sizeof(profnode_t) * p->maxnodes)) == 0) {
+		free(p);
+		return(0);
+	}
+	deadz80_profile_reset(p);
+	return(p);
+}
+
+void deadz80_profile_destroy(deadz80_profile_t *p)
+{
+	if (p) {
+		free(p->nodes);
+		free(p);
+	}
+}
+
+void deadz80_profile_reset(deadz80_profile_t *p)
+{
+	memset(p->hits, 0, sizeof(p->hits));
+	memset(p->cycles, 0, sizeof(p->cycles));
+	memset(p->calls, 0, sizeof(p->calls));
+	memset(p->inclusive, 0, sizeof(p->inclusive));
+	memset(p->active, 0, sizeof(p->active));
+	memset(p->buckets, 0, sizeof(p->buckets));
+	p->depth = 0;
+	p->total = 0;
+
+	//node 0 is the root, code running outside of any call seen
+	p->numnodes = 1;
+	p->nodes[0].parent = 0;
+	p->nodes[0].next = 0;
+	p->nodes[0].addr = 0;
+	p->nodes[0].cycles = 0;
+}
+
+//push a frame for a call, rst or interrupt that just jumped to addr
+void deadz80_profile_call(deadz80_profile_t *p, u16 addr, u16 sp)
+{
+	profframe_t *f;
+
+	//too deep, the frame is dropped and its return pops nothing
+	if (p->depth == PROFILE_MAXDEPTH)
+		return;
+
+	f = &p->stack[p->depth];
+	f->node = node_find(p, p->depth ? p->stack[p->depth - 1].node : 0, addr);
+	f->addr = addr;
+	f->sp = sp;
+	f->start = p->total;
+	p->depth++;
+	p->calls[addr]++;
+	p->active[addr]++;
+}
+
+//pop every frame whose return address lies below the new sp.  this also
+//unwinds frames left behind by code that resets sp or discards a return.
+static void profile_return(deadz80_profile_t *p, u16 sp)
+{
+	profframe_t *f;
+
+	while (p->depth && p->stack[p->depth - 1].sp < sp) {
+		f = &p->stack[--p->depth];
+		if (--p->active[f->addr] == 0)
+			p->inclusive[f->addr] += p->total - f->start;
+	}
+}
+
+//called by the instrumented core after every instruction with the pc and
+//sp from before it ran
+void deadz80_profile_step(deadz80_profile_t *p, deadz80_t *z, u16 pc, u16 sp, u32 cycles)
+{
+	u8 op = z->opcode;
+
+	p->hits[pc]++;
+	p->cycles[pc] += cycles;
+	p->total += cycles;
+	p->nodes[p->depth ? p->stack[p->depth - 1].node : 0].cycles += cycles;
+
+	//call nn, call cc,nn and rst n
+	if (z->sp == (u16)(sp - 2)) {
+		if (op == 0xCD || (op & 0xC7) == 0xC4 || (op & 0xC7) == 0xC7)
+			deadz80_profile_call(p, z->pc, z->sp);
+	}
+
+	//ret, ret cc, reti and retn
+	else if (z->sp == (u16)(sp + 2)) {
+		if (op == 0xC9 || (op & 0xC7) == 0xC0 || (op == 0xED && (deadz80_peek(pc + 1) & 0xC7) == 0x45))
+			profile_return(p, z->sp);
+	}
+}
+
+//write one line per function: entry address, calls, inclusive and
+//exclusive cycles.  functions still on the shadow stack are included.
+int deadz80_profile_write_functions(deadz80_profile_t *p, FILE *fp)
+{
+	u64 *exclusive, *inclusive;
+	u32 n;
+	int i, j;
+
+	exclusive = (u64*)calloc(0x10000, sizeof(u64));
+	inclusive = (u64*)malloc(0x10000 * sizeof(u64));
+	if (exclusive == 0 || inclusive == 0) {
+		free(exclusive);
+		free(inclusive);
+		return(1);
+	}
+
+	memcpy(inclusive, p->inclusive, 0x10000 * sizeof(u64));
+	for (i = 0; i < p->depth; i++) {
+		for (j = 0; j < i; j++) {
+			if (p->stack[j].addr == p->stack[i].addr)
+				break;
+		}
+		if (j == i)
+			inclusive[p->stack[i].addr] += p->total - p->stack[i].start;
+	}
+	for (n = 1; n < p->numnodes; n++)
+		exclusive[p->nodes[n].addr] += p->nodes[n].cycles;
+
+	fprintf(fp, "addr   calls      inclusive            exclusive\n");
+	for (n = 0; n < 0x10000; n++) {
+		if (p->calls[n] == 0 && exclusive[n] == 0)
+			continue;
+		fprintf(fp, "$%04X  %-10u %-20llu %llu\n", n, p->calls[n], inclusive[n], exclusive[n]);
+	}
+	free(exclusive);
+	free(inclusive);
+	return(0);
+}
+
+//write the calling context tree as folded stacks for flamegraph.pl
+int deadz80_profile_write_folded(deadz80_profile_t *p, FILE *fp)
+{
+	u32 path[PROFILE_MAXDEPTH + 1];
+	u32 n, node;
+	int len;
+
+	for (n = 0; n < p->numnodes; n++) {
+		if (p->nodes[n].cycles == 0)
+			continue;
+		len = 0;
+		for (node = n; node != 0 && len <= PROFILE_MAXDEPTH; node = p->nodes[node].parent)
+			path[len++] = node;
+		fprintf(fp, "z80");
+		while (len--)
+			fprintf(fp, ";$%04X", p->nodes[path[len]].addr);
+		fprintf(fp, " %llu\n", p->nodes[n].cycles);
+	}
+	return(0);
+}
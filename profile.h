@@ -0,0 +1,58 @@
+#ifndef __deadz80_profile_h__
+#define __deadz80_profile_h__
+
+#include <stdio.h>
+#include "deadz80.h"
+
+#define PROFILE_MAXDEPTH	256
+
+//one node of the calling context tree, a function reached through a
+//particular chain of callers
+typedef struct profnode_s {
+	u32			parent;					//index of the calling node (0 = root)
+	u32			next;						//next node in the same hash bucket
+	u16			addr;						//entry address of the function
+	u64			cycles;					//cycles spent in this node itself
+} profnode_t;
+
+//one entry of the shadow call stack
+typedef struct profframe_s {
+	u32			node;						//calling context tree node
+	u16			addr;						//entry address of the function
+	u16			sp;						//sp right after the return address was pushed
+	u64			start;					//profile cycle count at entry
+} profframe_t;
+
+typedef struct deadz80_profile_s {
+	u32			hits[0x10000];			//times an instruction at each pc was executed
+	u64			cycles[0x10000];		//cycles spent in the instruction at each pc
+
+	u32			calls[0x10000];		//calls per function entry address
+	u64			inclusive[0x10000];	//cycles from entry to return, per function
+	u16			active[0x10000];		//recursion depth, so inclusive is counted once
+
+	profframe_t	stack[PROFILE_MAXDEPTH];
+	int			depth;
+
+	profnode_t	*nodes;
+	u32			numnodes, maxnodes;
+	u32			buckets[4096];
+
+	u64			total;					//cycles seen by the profiler
+} deadz80_profile_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+	deadz80_profile_t *deadz80_profile_create();
+	void deadz80_profile_destroy(deadz80_profile_t *p);
+	void deadz80_profile_reset(deadz80_profile_t *p);
+	void deadz80_profile_step(deadz80_profile_t *p, deadz80_t *z, u16 pc, u16 sp, u32 cycles);
+	void deadz80_profile_call(deadz80_profile_t *p, u16 addr, u16 sp);
+	int deadz80_profile_write_functions(deadz80_profile_t *p, FILE *fp);
+	int deadz80_profile_write_folded(deadz80_profile_t *p, FILE *fp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
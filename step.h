@@ -0,0 +1,2072 @@
+//opcode execution functions, included once per core flavour by deadz80.c.
+//CORE(name) gives each flavour its own function names and FLAGS_XY selects
+//whether the undocumented x/y flag bits are computed.
+
+__inline void CORE(step_cb)()
+{
+	unsigned char opcode = read8(PC++);
+	unsigned char tmp, tmp2;
+
+	M1++;
+
+	switch (opcode) {
+	case 0x00:	RLC(B);		CYCLES += 8;	break;
+	case 0x01:	RLC(C);		CYCLES += 8;	break;
+	case 0x02:	RLC(D);		CYCLES += 8;	break;
+	case 0x03:	RLC(E);		CYCLES += 8;	break;
+	case 0x04:	RLC(H);		CYCLES += 8;	break;
+	case 0x05:	RLC(L);		CYCLES += 8;	break;
+	case 0x06:	tmp2 = read8(HL);	RLC(tmp2);	write8(HL, tmp2);	CYCLES += 15;	break;
+	case 0x07:	RLC(A);		CYCLES += 8;	break;
+	case 0x08:	RRC(B);		CYCLES += 8;	break;
+	case 0x09:	RRC(C);		CYCLES += 8;	break;
+	case 0x0A:	RRC(D);		CYCLES += 8;	break;
+	case 0x0B:	RRC(E);		CYCLES += 8;	break;
+	case 0x0C:	RRC(H);		CYCLES += 8;	break;
+	case 0x0D:	RRC(L);		CYCLES += 8;	break;
+	case 0x0E:	tmp2 = read8(HL);	RRC(tmp2);	write8(HL, tmp2);	CYCLES += 15;	break;
+	case 0x0F:	RRC(A);		CYCLES += 8;	break;
+	case 0x10:	RL(B);		CYCLES += 8;	break;
+	case 0x11:	RL(C);		CYCLES += 8;	break;
+	case 0x12:	RL(D);		CYCLES += 8;	break;
+	case 0x13:	RL(E);		CYCLES += 8;	break;
+	case 0x14:	RL(H);		CYCLES += 8;	break;
+	case 0x15:	RL(L);		CYCLES += 8;	break;
+	case 0x16:	tmp2 = read8(HL);	RL(tmp2);	write8(HL, tmp2);	CYCLES += 15;	break;
+	case 0x17:	RL(A);		CYCLES += 8;	break;
+	case 0x18:	RR(B);		CYCLES += 8;	break;
+	case 0x19:	RR(C);		CYCLES += 8;	break;
+	case 0x1A:	RR(D);		CYCLES += 8;	break;
+	case 0x1B:	RR(E);		CYCLES += 8;	break;
+	case 0x1C:	RR(H);		CYCLES += 8;	break;
+	case 0x1D:	RR(L);		CYCLES += 8;	break;
+	case 0x1E:	tmp2 = read8(HL);	RR(tmp2);	write8(HL, tmp2);	CYCLES += 15;	break;
+	case 0x1F:	RR(A);		CYCLES += 8;	break;
+	case 0x20:	SLA(B);		CYCLES += 8;	break;
+	case 0x21:	SLA(C);		CYCLES += 8;	break;
+	case 0x22:	SLA(D);		CYCLES += 8;	break;
+	case 0x23:	SLA(E);		CYCLES += 8;	break;
+	case 0x24:	SLA(H);		CYCLES += 8;	break;
+	case 0x25:	SLA(L);		CYCLES += 8;	break;
+	case 0x26:	tmp = read8(HL);	SLA(tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0x27:	SLA(A);		CYCLES += 8;	break;
+	case 0x28:	SRA(B);		CYCLES += 8;	break;
+	case 0x29:	SRA(C);		CYCLES += 8;	break;
+	case 0x2A:	SRA(D);		CYCLES += 8;	break;
+	case 0x2B:	SRA(E);		CYCLES += 8;	break;
+	case 0x2C:	SRA(H);		CYCLES += 8;	break;
+	case 0x2D:	SRA(L);		CYCLES += 8;	break;
+	case 0x2E:	tmp = read8(HL);	SRA(tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0x2F:	SRA(A);		CYCLES += 8;	break;
+	case 0x30:	SLL(B);		CYCLES += 8;	break;
+	case 0x31:	SLL(C);		CYCLES += 8;	break;
+	case 0x32:	SLL(D);		CYCLES += 8;	break;
+	case 0x33:	SLL(E);		CYCLES += 8;	break;
+	case 0x34:	SLL(H);		CYCLES += 8;	break;
+	case 0x35:	SLL(L);		CYCLES += 8;	break;
+	case 0x36:	tmp = read8(HL);	SLL(tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0x37:	SLL(A);		CYCLES += 8;	break;
+	case 0x38:	SRL(B);		CYCLES += 8;	break;
+	case 0x39:	SRL(C);		CYCLES += 8;	break;
+	case 0x3A:	SRL(D);		CYCLES += 8;	break;
+	case 0x3B:	SRL(E);		CYCLES += 8;	break;
+	case 0x3C:	SRL(H);		CYCLES += 8;	break;
+	case 0x3D:	SRL(L);		CYCLES += 8;	break;
+	case 0x3E:	tmp = read8(HL);	SRL(tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0x3F:	SRL(A);		CYCLES += 8;	break;
+	case 0x40:	BIT(0, B);	CYCLES += 8;	break;
+	case 0x41:	BIT(0, C);	CYCLES += 8;	break;
+	case 0x42:	BIT(0, D);	CYCLES += 8;	break;
+	case 0x43:	BIT(0, E);	CYCLES += 8;	break;
+	case 0x44:	BIT(0, H);	CYCLES += 8;	break;
+	case 0x45:	BIT(0, L);	CYCLES += 8;	break;
+	case 0x46:	tmp = read8(HL);	BIT_HL(0, tmp);	CYCLES += 12;	break;
+	case 0x47:	BIT(0, A);	CYCLES += 8;	break;
+	case 0x48:	BIT(1, B);	CYCLES += 8;	break;
+	case 0x49:	BIT(1, C);	CYCLES += 8;	break;
+	case 0x4A:	BIT(1, D);	CYCLES += 8;	break;
+	case 0x4B:	BIT(1, E);	CYCLES += 8;	break;
+	case 0x4C:	BIT(1, H);	CYCLES += 8;	break;
+	case 0x4D:	BIT(1, L);	CYCLES += 8;	break;
+	case 0x4E:	tmp = read8(HL);	BIT_HL(1, tmp);	CYCLES += 12;	break;
+	case 0x4F:	BIT(1, A);	CYCLES += 8;	break;
+	case 0x50:	BIT(2, B);	CYCLES += 8;	break;
+	case 0x51:	BIT(2, C);	CYCLES += 8;	break;
+	case 0x52:	BIT(2, D);	CYCLES += 8;	break;
+	case 0x53:	BIT(2, E);	CYCLES += 8;	break;
+	case 0x54:	BIT(2, H);	CYCLES += 8;	break;
+	case 0x55:	BIT(2, L);	CYCLES += 8;	break;
+	case 0x56:	tmp = read8(HL);	BIT_HL(2, tmp);	CYCLES += 12;	break;
+	case 0x57:	BIT(2, A);	CYCLES += 8;	break;
+	case 0x58:	BIT(3, B);	CYCLES += 8;	break;
+	case 0x59:	BIT(3, C);	CYCLES += 8;	break;
+	case 0x5A:	BIT(3, D);	CYCLES += 8;	break;
+	case 0x5B:	BIT(3, E);	CYCLES += 8;	break;
+	case 0x5C:	BIT(3, H);	CYCLES += 8;	break;
+	case 0x5D:	BIT(3, L);	CYCLES += 8;	break;
+	case 0x5E:	tmp = read8(HL);	BIT_HL(3, tmp);	CYCLES += 12;	break;
+	case 0x5F:	BIT(3, A);	CYCLES += 8;	break;
+	case 0x60:	BIT(4, B);	CYCLES += 8;	break;
+	case 0x61:	BIT(4, C);	CYCLES += 8;	break;
+	case 0x62:	BIT(4, D);	CYCLES += 8;	break;
+	case 0x63:	BIT(4, E);	CYCLES += 8;	break;
+	case 0x64:	BIT(4, H);	CYCLES += 8;	break;
+	case 0x65:	BIT(4, L);	CYCLES += 8;	break;
+	case 0x66:	tmp = read8(HL);	BIT_HL(4, tmp);	CYCLES += 12;	break;
+	case 0x67:	BIT(4, A);	CYCLES += 8;	break;
+	case 0x68:	BIT(5, B);	CYCLES += 8;	break;
+	case 0x69:	BIT(5, C);	CYCLES += 8;	break;
+	case 0x6A:	BIT(5, D);	CYCLES += 8;	break;
+	case 0x6B:	BIT(5, E);	CYCLES += 8;	break;
+	case 0x6C:	BIT(5, H);	CYCLES += 8;	break;
+	case 0x6D:	BIT(5, L);	CYCLES += 8;	break;
+	case 0x6E:	tmp = read8(HL);	BIT_HL(5, tmp);	CYCLES += 12;	break;
+	case 0x6F:	BIT(5, A);	CYCLES += 8;	break;
+	case 0x70:	BIT(6, B);	CYCLES += 8;	break;
+	case 0x71:	BIT(6, C);	CYCLES += 8;	break;
+	case 0x72:	BIT(6, D);	CYCLES += 8;	break;
+	case 0x73:	BIT(6, E);	CYCLES += 8;	break;
+	case 0x74:	BIT(6, H);	CYCLES += 8;	break;
+	case 0x75:	BIT(6, L);	CYCLES += 8;	break;
+	case 0x76:	tmp = read8(HL);	BIT_HL(6, tmp);	CYCLES += 12;	break;
+	case 0x77:	BIT(6, A);	CYCLES += 8;	break;
+	case 0x78:	BIT(7, B);	CYCLES += 8;	break;
+	case 0x79:	BIT(7, C);	CYCLES += 8;	break;
+	case 0x7A:	BIT(7, D);	CYCLES += 8;	break;
+	case 0x7B:	BIT(7, E);	CYCLES += 8;	break;
+	case 0x7C:	BIT(7, H);	CYCLES += 8;	break;
+	case 0x7D:	BIT(7, L);	CYCLES += 8;	break;
+	case 0x7E:	tmp = read8(HL);	BIT_HL(7, tmp);	CYCLES += 12;	break;
+	case 0x7F:	BIT(7, A);	CYCLES += 8;	break;
+	case 0x80:	RES(0, B);	CYCLES += 8;	break;
+	case 0x81:	RES(0, C);	CYCLES += 8;	break;
+	case 0x82:	RES(0, D);	CYCLES += 8;	break;
+	case 0x83:	RES(0, E);	CYCLES += 8;	break;
+	case 0x84:	RES(0, H);	CYCLES += 8;	break;
+	case 0x85:	RES(0, L);	CYCLES += 8;	break;
+	case 0x86:	tmp = read8(HL);	RES(0, tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0x87:	RES(0, A);	CYCLES += 8;	break;
+	case 0x88:	RES(1, B);	CYCLES += 8;	break;
+	case 0x89:	RES(1, C);	CYCLES += 8;	break;
+	case 0x8A:	RES(1, D);	CYCLES += 8;	break;
+	case 0x8B:	RES(1, E);	CYCLES += 8;	break;
+	case 0x8C:	RES(1, H);	CYCLES += 8;	break;
+	case 0x8D:	RES(1, L);	CYCLES += 8;	break;
+	case 0x8E:	tmp = read8(HL);	RES(1, tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0x8F:	RES(1, A);	CYCLES += 8;	break;
+	case 0x90:	RES(2, B);	CYCLES += 8;	break;
+	case 0x91:	RES(2, C);	CYCLES += 8;	break;
+	case 0x92:	RES(2, D);	CYCLES += 8;	break;
+	case 0x93:	RES(2, E);	CYCLES += 8;	break;
+	case 0x94:	RES(2, H);	CYCLES += 8;	break;
+	case 0x95:	RES(2, L);	CYCLES += 8;	break;
+	case 0x96:	tmp = read8(HL);	RES(2, tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0x97:	RES(2, A);	CYCLES += 8;	break;
+	case 0x98:	RES(3, B);	CYCLES += 8;	break;
+	case 0x99:	RES(3, C);	CYCLES += 8;	break;
+	case 0x9A:	RES(3, D);	CYCLES += 8;	break;
+	case 0x9B:	RES(3, E);	CYCLES += 8;	break;
+	case 0x9C:	RES(3, H);	CYCLES += 8;	break;
+	case 0x9D:	RES(3, L);	CYCLES += 8;	break;
+	case 0x9E:	tmp = read8(HL);	RES(3, tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0x9F:	RES(3, A);	CYCLES += 8;	break;
+	case 0xA0:	RES(4, B);	CYCLES += 8;	break;
+	case 0xA1:	RES(4, C);	CYCLES += 8;	break;
+	case 0xA2:	RES(4, D);	CYCLES += 8;	break;
+	case 0xA3:	RES(4, E);	CYCLES += 8;	break;
+	case 0xA4:	RES(4, H);	CYCLES += 8;	break;
+	case 0xA5:	RES(4, L);	CYCLES += 8;	break;
+	case 0xA6:	tmp = read8(HL);	RES(4, tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0xA7:	RES(4, A);	CYCLES += 8;	break;
+	case 0xA8:	RES(5, B);	CYCLES += 8;	break;
+	case 0xA9:	RES(5, C);	CYCLES += 8;	break;
+	case 0xAA:	RES(5, D);	CYCLES += 8;	break;
+	case 0xAB:	RES(5, E);	CYCLES += 8;	break;
+	case 0xAC:	RES(5, H);	CYCLES += 8;	break;
+	case 0xAD:	RES(5, L);	CYCLES += 8;	break;
+	case 0xAE:	tmp = read8(HL);	RES(5, tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0xAF:	RES(5, A);	CYCLES += 8;	break;
+	case 0xB0:	RES(6, B);	CYCLES += 8;	break;
+	case 0xB1:	RES(6, C);	CYCLES += 8;	break;
+	case 0xB2:	RES(6, D);	CYCLES += 8;	break;
+	case 0xB3:	RES(6, E);	CYCLES += 8;	break;
+	case 0xB4:	RES(6, H);	CYCLES += 8;	break;
+	case 0xB5:	RES(6, L);	CYCLES += 8;	break;
+	case 0xB6:	tmp = read8(HL);	RES(6, tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0xB7:	RES(6, A);	CYCLES += 8;	break;
+	case 0xB8:	RES(7, B);	CYCLES += 8;	break;
+	case 0xB9:	RES(7, C);	CYCLES += 8;	break;
+	case 0xBA:	RES(7, D);	CYCLES += 8;	break;
+	case 0xBB:	RES(7, E);	CYCLES += 8;	break;
+	case 0xBC:	RES(7, H);	CYCLES += 8;	break;
+	case 0xBD:	RES(7, L);	CYCLES += 8;	break;
+	case 0xBE:	tmp = read8(HL);	RES(7, tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0xBF:	RES(7, A);	CYCLES += 8;	break;
+	case 0xC0:	SET(0, B);	CYCLES += 8;	break;
+	case 0xC1:	SET(0, C);	CYCLES += 8;	break;
+	case 0xC2:	SET(0, D);	CYCLES += 8;	break;
+	case 0xC3:	SET(0, E);	CYCLES += 8;	break;
+	case 0xC4:	SET(0, H);	CYCLES += 8;	break;
+	case 0xC5:	SET(0, L);	CYCLES += 8;	break;
+	case 0xC6:	tmp = read8(HL);	SET(0, tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0xC7:	SET(0, A);	CYCLES += 8;	break;
+	case 0xC8:	SET(1, B);	CYCLES += 8;	break;
+	case 0xC9:	SET(1, C);	CYCLES += 8;	break;
+	case 0xCA:	SET(1, D);	CYCLES += 8;	break;
+	case 0xCB:	SET(1, E);	CYCLES += 8;	break;
+	case 0xCC:	SET(1, H);	CYCLES += 8;	break;
+	case 0xCD:	SET(1, L);	CYCLES += 8;	break;
+	case 0xCE:	tmp = read8(HL);	SET(1, tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0xCF:	SET(1, A);	CYCLES += 8;	break;
+	case 0xD0:	SET(2, B);	CYCLES += 8;	break;
+	case 0xD1:	SET(2, C);	CYCLES += 8;	break;
+	case 0xD2:	SET(2, D);	CYCLES += 8;	break;
+	case 0xD3:	SET(2, E);	CYCLES += 8;	break;
+	case 0xD4:	SET(2, H);	CYCLES += 8;	break;
+	case 0xD5:	SET(2, L);	CYCLES += 8;	break;
+	case 0xD6:	tmp = read8(HL);	SET(2, tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0xD7:	SET(2, A);	CYCLES += 8;	break;
+	case 0xD8:	SET(3, B);	CYCLES += 8;	break;
+	case 0xD9:	SET(3, C);	CYCLES += 8;	break;
+	case 0xDA:	SET(3, D);	CYCLES += 8;	break;
+	case 0xDB:	SET(3, E);	CYCLES += 8;	break;
+	case 0xDC:	SET(3, H);	CYCLES += 8;	break;
+	case 0xDD:	SET(3, L);	CYCLES += 8;	break;
+	case 0xDE:	tmp = read8(HL);	SET(3, tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0xDF:	SET(3, A);	CYCLES += 8;	break;
+	case 0xE0:	SET(4, B);	CYCLES += 8;	break;
+	case 0xE1:	SET(4, C);	CYCLES += 8;	break;
+	case 0xE2:	SET(4, D);	CYCLES += 8;	break;
+	case 0xE3:	SET(4, E);	CYCLES += 8;	break;
+	case 0xE4:	SET(4, H);	CYCLES += 8;	break;
+	case 0xE5:	SET(4, L);	CYCLES += 8;	break;
+	case 0xE6:	tmp = read8(HL);	SET(4, tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0xE7:	SET(4, A);	CYCLES += 8;	break;
+	case 0xE8:	SET(5, B);	CYCLES += 8;	break;
+	case 0xE9:	SET(5, C);	CYCLES += 8;	break;
+	case 0xEA:	SET(5, D);	CYCLES += 8;	break;
+	case 0xEB:	SET(5, E);	CYCLES += 8;	break;
+	case 0xEC:	SET(5, H);	CYCLES += 8;	break;
+	case 0xED:	SET(5, L);	CYCLES += 8;	break;
+	case 0xEE:	tmp = read8(HL);	SET(5, tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0xEF:	SET(5, A);	CYCLES += 8;	break;
+	case 0xF0:	SET(6, B);	CYCLES += 8;	break;
+	case 0xF1:	SET(6, C);	CYCLES += 8;	break;
+	case 0xF2:	SET(6, D);	CYCLES += 8;	break;
+	case 0xF3:	SET(6, E);	CYCLES += 8;	break;
+	case 0xF4:	SET(6, H);	CYCLES += 8;	break;
+	case 0xF5:	SET(6, L);	CYCLES += 8;	break;
+	case 0xF6:	tmp = read8(HL);	SET(6, tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0xF7:	SET(6, A);	CYCLES += 8;	break;
+	case 0xF8:	SET(7, B);	CYCLES += 8;	break;
+	case 0xF9:	SET(7, C);	CYCLES += 8;	break;
+	case 0xFA:	SET(7, D);	CYCLES += 8;	break;
+	case 0xFB:	SET(7, E);	CYCLES += 8;	break;
+	case 0xFC:	SET(7, H);	CYCLES += 8;	break;
+	case 0xFD:	SET(7, L);	CYCLES += 8;	break;
+	case 0xFE:	tmp = read8(HL);	SET(7, tmp);	write8(HL, tmp);	CYCLES += 15;	break;
+	case 0xFF:	SET(7, A);	CYCLES += 8;	break;
+	default:
+		printf("bad CB opcode $%02X\n", opcode);
+		break;
+	}
+}
+
+__inline void CORE(step_ddcb)()
+{
+	unsigned char data = read8(PC++);
+	unsigned char opcode = read8(PC++);
+	unsigned char tmp, tmp2;
+	unsigned long ltmp;
+
+	ltmp = (unsigned long)(IX + (signed char)data);
+		switch (opcode) {
+		case 0x01:
+			tmp2 = read8(ltmp);
+			RLC(tmp2);
+			write8(ltmp, tmp2);
+			C = tmp2;
+			CYCLES += 23;
+			break; //rlc (ix+n),c
+		case 0x06: tmp2 = read8(ltmp); RLC(tmp2); write8(ltmp, tmp2); CYCLES += 23; break; //rlc (ix+n)
+		case 0x0E: tmp2 = read8(ltmp); RRC(tmp2); write8(ltmp, tmp2); CYCLES += 23; break; //rrc (ix+n)
+		case 0x16: tmp2 = read8(ltmp); RL(tmp2);  write8(ltmp, tmp2); CYCLES += 23; break; //rl (ix+n)
+		case 0x1E: tmp2 = read8(ltmp); RR(tmp2);  write8(ltmp, tmp2); CYCLES += 23; break; //rr (ix+n)
+		case 0x26: tmp2 = read8(ltmp); SLA(tmp2); write8(ltmp, tmp2); CYCLES += 23; break; //sla (ix+n)
+		case 0x2E: tmp2 = read8(ltmp); SRA(tmp2); write8(ltmp, tmp2); CYCLES += 23; break; //sra (ix+n)
+		case 0x36: tmp2 = read8(ltmp); SLL(tmp2); write8(ltmp, tmp2); CYCLES += 23; break; //sla (ix+n)
+		case 0x3E: tmp2 = read8(ltmp); SRL(tmp2); write8(ltmp, tmp2); CYCLES += 23; break; //sra (ix+n)
+		case 0x40:
+		case 0x41:
+		case 0x42:
+		case 0x43:
+		case 0x44:
+		case 0x45:
+		case 0x46:	//bit 0,(ix+n)
+		case 0x47:	BIT_IDX(0);							break;
+		case 0x48:
+		case 0x49:
+		case 0x4A:
+		case 0x4B:
+		case 0x4C:
+		case 0x4D:
+		case 0x4E:	//bit 1,(ix+n)
+		case 0x4F:	BIT_IDX(1);							break;
+		case 0x50:
+		case 0x51:
+		case 0x52:
+		case 0x53:
+		case 0x54:
+		case 0x55:
+		case 0x56:	//bit 2,(ix+n)
+		case 0x57:	BIT_IDX(2);							break;
+		case 0x58:
+		case 0x59:
+		case 0x5A:
+		case 0x5B:
+		case 0x5C:
+		case 0x5D:
+		case 0x5E:	//bit 3,(ix+n)
+		case 0x5F:	BIT_IDX(3);							break;
+		case 0x60:
+		case 0x61:
+		case 0x62:
+		case 0x63:
+		case 0x64:
+		case 0x65:
+		case 0x66:	//bit 4,(ix+n)
+		case 0x67:	BIT_IDX(4);							break;
+		case 0x68:
+		case 0x69:
+		case 0x6A:
+		case 0x6B:
+		case 0x6C:
+		case 0x6D:
+		case 0x6E:	//bit 5,(ix+n)
+		case 0x6F:	BIT_IDX(5);							break;
+		case 0x70:
+		case 0x71:
+		case 0x72:
+		case 0x73:
+		case 0x74:
+		case 0x75:
+		case 0x76:	//bit 6,(ix+n)
+		case 0x77:	BIT_IDX(6);							break;
+		case 0x78:
+		case 0x79:
+		case 0x7A:
+		case 0x7B:
+		case 0x7C:
+		case 0x7D:
+		case 0x7E:	//bit 7,(ix+n)
+		case 0x7F:	BIT_IDX(7);							break;
+		case 0x80:
+		case 0x81:
+		case 0x82:
+		case 0x83:
+		case 0x84:
+		case 0x85:
+		case 0x86:	//res 0,(ix+n)
+		case 0x87:	RES_IDX(0);							break;
+		case 0x88:
+		case 0x89:
+		case 0x8A:
+		case 0x8B:
+		case 0x8C:
+		case 0x8D:
+		case 0x8E:	//res 1,(ix+n)
+		case 0x8F:	RES_IDX(1);							break;
+		case 0x90:
+		case 0x91:
+		case 0x92:
+		case 0x93:
+		case 0x94:
+		case 0x95:
+		case 0x96:	//res 2,(ix+n)
+		case 0x97:	RES_IDX(2);							break;
+		case 0x98:
+		case 0x99:
+		case 0x9A:
+		case 0x9B:
+		case 0x9C:
+		case 0x9D:
+		case 0x9E:	//res 3,(ix+n)
+		case 0x9F:	RES_IDX(3);							break;
+		case 0xA0:
+		case 0xA1:
+		case 0xA2:
+		case 0xA3:
+		case 0xA4:
+		case 0xA5:
+		case 0xA6:	//res 4,(ix+n)
+		case 0xA7:	RES_IDX(4);							break;
+		case 0xA8:
+		case 0xA9:
+		case 0xAA:
+		case 0xAB:
+		case 0xAC:
+		case 0xAD:
+		case 0xAE:	//res 5,(ix+n)
+		case 0xAF:	RES_IDX(5);							break;
+		case 0xB0:
+		case 0xB1:
+		case 0xB2:
+		case 0xB3:
+		case 0xB4:
+		case 0xB5:
+		case 0xB6:	//res 6,(ix+n)
+		case 0xB7:	RES_IDX(6);							break;
+		case 0xB8:
+		case 0xB9:
+		case 0xBA:
+		case 0xBB:
+		case 0xBC:
+		case 0xBD:
+		case 0xBE:	//res 7,(ix+n)
+		case 0xBF:	RES_IDX(7);							break;
+		case 0xC0:
+		case 0xC1:
+		case 0xC2:
+		case 0xC3:
+		case 0xC4:
+		case 0xC5:
+		case 0xC6:	//set 0,(ix+n)
+		case 0xC7:	SET_IDX(0);							break;
+		case 0xC8:
+		case 0xC9:
+		case 0xCA:
+		case 0xCB:
+		case 0xCC:
+		case 0xCD:
+		case 0xCE:	//set 1,(ix+n)
+		case 0xCF:	SET_IDX(1);							break;
+		case 0xD0:
+		case 0xD1:
+		case 0xD2:
+		case 0xD3:
+		case 0xD4:
+		case 0xD5:
+		case 0xD6:	//set 2,(ix+n)
+		case 0xD7:	SET_IDX(2);							break;
+		case 0xD8:
+		case 0xD9:
+		case 0xDA:
+		case 0xDB:
+		case 0xDC:
+		case 0xDD:
+		case 0xDE:	//set 3,(ix+n)
+		case 0xDF:	SET_IDX(3);							break;
+		case 0xE0:
+		case 0xE1:
+		case 0xE2:
+		case 0xE3:
+		case 0xE4:
+		case 0xE5:
+		case 0xE6:	//set 4,(ix+n)
+		case 0xE7:	SET_IDX(4);							break;
+		case 0xE8:
+		case 0xE9:
+		case 0xEA:
+		case 0xEB:
+		case 0xEC:
+		case 0xED:
+		case 0xEE:	//set 5,(ix+n)
+		case 0xEF:	SET_IDX(5);							break;
+		case 0xF0:
+		case 0xF1:
+		case 0xF2:
+		case 0xF3:
+		case 0xF4:
+		case 0xF5:
+		case 0xF6:	//set 6,(ix+n)
+		case 0xF7:	SET_IDX(6);							break;
+		case 0xF8:
+		case 0xF9:
+		case 0xFA:
+		case 0xFB:
+		case 0xFC:
+		case 0xFD:
+		case 0xFE:	//set 7,(ix+n)
+		case 0xFF:	SET_IDX(7);							break;
+
+		default:
+			printf("bad DDCB opcode = $%02X\n", opcode);
+			break;
+	}
+}
+
+__inline void CORE(step_dd)()
+{
+	unsigned char opcode = read8(PC++);
+	unsigned short stmp;
+	unsigned char tmp;
+	unsigned long ltmp, otmp;
+
+	M1++;
+
+	switch (opcode) {
+	case 0x09:	ADD16(IX, BC);				CYCLES += 8;	break;
+	case 0x19:	ADD16(IX, DE);				CYCLES += 8;	break;
+
+	case 0x21:	//ld IX,nn
+		IX = read16(PC);
+		PC += 2;
+		CYCLES += 14;
+		break;
+	case 0x22:	//ld (nn),IX
+		write16(read16(PC), IX);
+		PC += 2;
+		CYCLES += 20;
+		break;
+	case 0x23:	//inc IX
+		IX++;
+		CYCLES += 10;
+		break;
+	case 0x24:	//inc ixh
+		tmp = (u8)(IXH);
+		INC(tmp);
+		IXH = tmp;
+		CYCLES += 8;
+		break;
+	case 0x25:	//dec ixh
+		tmp = (u8)(IXH);
+		DEC(tmp);
+		IXH = tmp;
+		CYCLES += 8;
+		break;
+
+	case 0x26:	//ld ixh,n
+		IX = (read8(PC++) << 8) | (IX & 0xFF);
+		CYCLES += 11;
+		break;
+	case 0x29:	ADD16(IX, IX);	CYCLES += 8;	break;
+	case 0x39:	ADD16(IX, SP);	CYCLES += 8;	break;
+
+	case 0x2A:	//ld IX,(nn)
+		IX = read16(read16(PC));
+		PC += 2;
+		CYCLES += 20;
+		break;
+	case 0x2B:	//dec IX
+		IX--;
+		CYCLES += 10;
+		break;
+	case 0x2C:	//inc ixl
+		tmp = (u8)(IXL);
+		INC(tmp);
+		IXL = tmp;
+		CYCLES += 8;
+		break;
+	case 0x2D:	//dec ixl
+		tmp = (u8)(IXL);
+		DEC(tmp);
+		IXL = tmp;
+		CYCLES += 8;
+		break;
+	case 0x2E:	//ld ixl,n
+		IX = read8(PC++) | (IX & 0xFF00);
+		CYCLES += 11;
+		break;
+
+	case 0x34:	//inc (IX+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		tmp = read8(ltmp);
+		INC(tmp);
+		write8(ltmp, tmp);
+		CYCLES += 23;
+		break;
+
+	case 0x35:	//dec (IX+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		tmp = read8(ltmp);
+		DEC(tmp);
+		write8(ltmp, tmp);
+		CYCLES += 23;
+		break;
+
+	case 0x36:	//ld (IX+d),n
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		write8(ltmp, read8(PC++));
+		CYCLES += 19;
+		break;
+
+	case 0x40:	B = B;								CYCLES += 8;	break;
+	case 0x41:	B = C;								CYCLES += 8;	break;
+	case 0x42:	B = D;								CYCLES += 8;	break;
+	case 0x43:	B = E;								CYCLES += 8;	break;
+	case 0x44:	B = IXH;							CYCLES += 8;	break;
+	case 0x45:	B = IXL;							CYCLES += 8;	break;
+	case 0x46:	//ld b,(IX+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		B = read8(ltmp);
+		CYCLES += 19;
+		break;
+	case 0x47:	B = A;								CYCLES += 8;	break;
+	case 0x48:	C = B;								CYCLES += 8;	break;
+	case 0x49:	C = C;								CYCLES += 8;	break;
+	case 0x4A:	C = D;								CYCLES += 8;	break;
+	case 0x4B:	C = E;								CYCLES += 8;	break;
+	case 0x4C:	C = IXH;							CYCLES += 8;	break;
+	case 0x4D:	C = IXL;							CYCLES += 8;	break;
+	case 0x4E:	//ld c,(IX+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		C = read8(ltmp);
+		CYCLES += 19;
+		break;
+	case 0x4F:	C = A;								CYCLES += 8;	break;
+	case 0x50:	D = B;								CYCLES += 8;	break;
+	case 0x51:	D = C;								CYCLES += 8;	break;
+	case 0x52:	D = D;								CYCLES += 8;	break;
+	case 0x53:	D = E;								CYCLES += 8;	break;
+	case 0x54:	D = IXH;							CYCLES += 8;	break;
+	case 0x55:	D = IXL;							CYCLES += 8;	break;
+	case 0x56:	//ld d,(IX+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		D = read8(ltmp);
+		CYCLES += 19;
+		break;
+	case 0x57:	D = A;								CYCLES += 8;	break;
+	case 0x58:	E = B;								CYCLES += 8;	break;
+	case 0x59:	E = C;								CYCLES += 8;	break;
+	case 0x5A:	E = D;								CYCLES += 8;	break;
+	case 0x5B:	E = E;								CYCLES += 8;	break;
+	case 0x5C:	E = IXH;							CYCLES += 8;	break;
+	case 0x5D:	E = IXL;							CYCLES += 8;	break;
+	case 0x5E:	//ld e,(IX+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		E = read8(ltmp);
+		CYCLES += 19;
+		break;
+	case 0x5F:	E = A;								CYCLES += 8;	break;
+	case 0x60:	IXH = B;							CYCLES += 8;	break;
+	case 0x61:	IXH = C;							CYCLES += 8;	break;
+	case 0x62:	IXH = D;							CYCLES += 8;	break;
+	case 0x63:	IXH = E;							CYCLES += 8;	break;
+	case 0x64:	IXH = IXH;							CYCLES += 8;	break;
+	case 0x65:	IXH = IXL;							CYCLES += 8;	break;
+	case 0x66:	//ld h,(IX+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		H = read8(ltmp);
+		CYCLES += 19;
+		break;
+	case 0x67:	IXH = A;							CYCLES += 8;	break;
+	case 0x68:	IXL = B;							CYCLES += 8;	break;
+	case 0x69:	IXL = C;							CYCLES += 8;	break;
+	case 0x6A:	IXL = D;							CYCLES += 8;	break;
+	case 0x6B:	IXL = E;							CYCLES += 8;	break;
+	case 0x6C:	IXL = IXH;							CYCLES += 8;	break;
+	case 0x6D:	IXL = IXL;							CYCLES += 8;	break;
+	case 0x6E:	//ld l,(IX+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		L = read8(ltmp);
+		CYCLES += 19;
+		break;
+	case 0x6F:	IXL = A;								CYCLES += 8;	break;
+
+	case 0x70:	//ld (IX+d),b
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		write8(ltmp, B);
+		CYCLES += 19;
+		break;
+	case 0x71:	//ld (IX+d),c
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		write8(ltmp, C);
+		CYCLES += 19;
+		break;
+	case 0x72:	//ld (IX+d),d
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		write8(ltmp, D);
+		CYCLES += 19;
+		break;
+	case 0x73:	//ld (IX+d),e
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		write8(ltmp, E);
+		CYCLES += 19;
+		break;
+	case 0x74:	//ld (IX+d),h
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		write8(ltmp, H);
+		CYCLES += 19;
+		break;
+	case 0x75:	//ld (IX+d),l
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		write8(ltmp, L);
+		CYCLES += 19;
+		break;
+
+	case 0x77:	//ld (IX+d),a
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		write8(ltmp, A);
+		CYCLES += 19;
+		break;
+	case 0x78:	A = B;								CYCLES += 8;	break;
+	case 0x79:	A = C;								CYCLES += 8;	break;
+	case 0x7A:	A = D;								CYCLES += 8;	break;
+	case 0x7B:	A = E;								CYCLES += 8;	break;
+	case 0x7C:	A = IXH;							CYCLES += 8;	break;
+	case 0x7D:	A = IXL;							CYCLES += 8;	break;
+	case 0x7E:	//ld a,(IX+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		A = read8(ltmp);
+		CYCLES += 19;
+		break;
+	case 0x7F:	A = A;								CYCLES += 8;	break;
+	case 0x84:	ADD(IXH);							CYCLES += 8;	break;
+	case 0x85:	ADD(IXL);							CYCLES += 8;	break;
+	case 0x86:	//add a,(IX+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		ADD(read8(ltmp));
+		CYCLES += 19;
+		break;
+	case 0x8C:	ADC(IXH);							CYCLES += 8;	break;
+	case 0x8D:	ADC(IXL);							CYCLES += 8;	break;
+	case 0x8E:	//adc a,(IX+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		ADC(read8(ltmp));
+		CYCLES += 19;
+		break;
+	case 0x94:	SUB(IXH);							CYCLES += 8;	break;
+	case 0x95:	SUB(IXL);							CYCLES += 8;	break;
+	case 0x96:	//sub a,(IX+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		SUB(read8(ltmp));
+		CYCLES += 19;
+		break;
+	case 0x9C:	SBC(IXH);							CYCLES += 8;	break;
+	case 0x9D:	SBC(IXL);							CYCLES += 8;	break;
+	case 0x9E:	//sbc a,(IX+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		SBC(read8(ltmp));
+		CYCLES += 19;
+		break;
+	case 0xA4:	AND(IXH);							CYCLES += 8;	break;
+	case 0xA5:	AND(IXL);							CYCLES += 8;	break;
+	case 0xA6:
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		tmp = read8(ltmp);
+		AND(tmp);
+		CYCLES += 19;
+		break;
+	case 0xAC:	XOR(IXH);							CYCLES += 8;	break;
+	case 0xAD:	XOR(IXL);							CYCLES += 8;	break;
+	case 0xAE:
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		tmp = read8(ltmp);
+		XOR(tmp);
+		CYCLES += 19;
+		break;
+	case 0xB4:	OR(IXH);							CYCLES += 8;	break;
+	case 0xB5:	OR(IXL);							CYCLES += 8;	break;
+	case 0xB6:
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		tmp = read8(ltmp);
+		OR(tmp);
+		CYCLES += 19;
+		break;
+	case 0xBC:	CP(IXH);							CYCLES += 8;	break;
+	case 0xBD:	CP(IXL);							CYCLES += 8;	break;
+	case 0xBE:
+		ltmp = (unsigned long)(unsigned short)((signed short)IX + (signed char)read8(PC++));
+		tmp = read8(ltmp);
+		CP(tmp);
+		CYCLES += 19;
+		break;
+	case 0xCB:	CORE(step_ddcb)(); break;
+	case 0xE1:	//pop IX
+		POP16(IX);
+		CYCLES += 14;
+		break;
+	case 0xE5:	//push IX
+		PUSH16(IX);
+		CYCLES += 15;
+		break;
+	default:
+		printf("bad DD opcode $%02X\n", opcode);
+		break;
+	}
+}
+
+__inline void CORE(step_ed)()
+{
+	unsigned char opcode = read8(PC++);
+	unsigned short stmp, tmp16;
+	unsigned char tmp;
+	unsigned long ltmp;
+	int itmp;
+
+	M1++;
+
+	switch (opcode) {
+	case 0x42:	SBC16(HL, BC);	CYCLES += 15;	break;	//sbc hl,bc
+	case 0x52:	SBC16(HL, DE);	CYCLES += 15;	break;	//sbc hl,de
+	case 0x62:	SBC16(HL, HL);	CYCLES += 15;	break;	//sbc hl,hl
+	case 0x72:	SBC16(HL, SP);	CYCLES += 15;	break;	//sbc hl,hl
+	case 0x7A:	ADC16(HL, SP);	CYCLES += 15;	break;	//sbc hl,hl
+	case 0x43:	//ld (nn),bc
+		write16(read16(PC), BC);
+		PC += 2;
+		CYCLES += 20;
+		break;
+	case 0x44:	//neg
+		itmp = -A;
+		stmp = A ^ itmp;
+		F = FLAG_N | (stmp & FLAG_H);
+		F |= (stmp >= 0x100) ? FLAG_C : 0;
+		F |= (itmp == 0) ? FLAG_Z : 0;
+		F |= (itmp & 0x80) ? FLAG_S : 0;
+		F |= (A == 0x80) ? FLAG_V : 0;
+		F |= (itmp & FLAGS_XY);
+		A = itmp;
+		CYCLES += 8;
+		break;
+	case 0x47:	//ld i,a
+		z80->i = A;
+		CYCLES += 9;
+		break;
+	case 0x4A:	ADC16(HL, BC);	CYCLES += 15;	break;	//sbc hl,bc
+	case 0x4B:	//ld bc,(nn)
+		BC = read16(read16(PC));
+		PC += 2;
+		CYCLES += 20;
+		break;
+	case 0x4D:	//TODO: is this complete?  reti
+		PC = read8(SP + 0) | (read8(SP + 1) << 8);
+		SP += 2;
+		CYCLES += 14;
+		break;
+	case 0x4F:	//ld r,a
+		deadz80_set_r(A);
+		CYCLES += 9;
+		break;
+	case 0x53:	//ld (nn),de
+		write16(read16(PC), DE);
+		PC += 2;
+		CYCLES += 20;
+		break;
+	case 0x56:	//im 1
+		z80->intmode = 1;
+		CYCLES += 8;
+		break;
+	case 0x57:	//ld a,i
+		LD_A_IR(z80->i);
+		CYCLES += 9;
+		break;
+	case 0x5A:	ADC16(HL, DE);		CYCLES += 15;	break;
+
+	case 0x5B:	//ld de,(nn)
+		DE = read16(read16(PC));
+		PC += 2;
+		CYCLES += 20;
+		break;
+	case 0x5F:	//ld a,r
+		LD_A_IR(deadz80_get_r());
+		CYCLES += 9;
+		break;
+	case 0x67: //rrd
+		tmp = read8(HL);
+		write8(HL, (tmp >> 4) | (A << 4));
+		A = (A & 0xF0) | (tmp & 0xF);
+		F &= FLAG_C;
+		F |= A & FLAGS_XY;
+		if (A == 0)
+			F |= FLAG_Z;
+		if (A & 0x80)
+			F |= FLAG_S;
+		if (parity[A])
+			F |= FLAG_P;
+		CYCLES += 18;
+		break;
+	case 0x6A:	ADC16(HL, HL);		CYCLES += 15;	break;
+
+	case 0x6B:	//ld hl,(nn)
+		HL = read16(read16(PC));
+		PC += 2;
+		CYCLES += 20;
+		break;
+	case 0x6F:
+		tmp = read8(HL);
+		write8(HL, (tmp << 4) | (A & 0xF));
+		A = (A & 0xF0) | (tmp >> 4);
+		F &= FLAG_C;
+		F |= A & FLAGS_XY;
+		if (A == 0)
+			F |= FLAG_Z;
+		if (A & 0x80)
+			F |= FLAG_S;
+		if (parity[A])
+			F |= FLAG_P;
+		CYCLES += 18;
+		break;
+	case 0x7B:	//ld SP,(nn)
+		SP = read16(read16(PC));
+		PC += 2;
+		CYCLES += 20;
+		break;
+
+	case 0x73:	//LD (nn),SP
+		write16(read16(PC), SP);
+		PC += 2;
+		CYCLES += 20;
+		break;
+
+	case 0xA0:	//ldi
+		stmp = read8(HL++);
+		write8(DE++, stmp);
+		F &= (FLAG_S | FLAG_Z | FLAG_C);
+		F |= --BC ? FLAG_P : 0;
+		stmp += A;
+		BLOCKXY(stmp);
+		CYCLES += 16;
+		break;
+
+	case 0xA1:	//cpi
+		tmp = read8(HL++);
+		stmp = A - tmp;
+		BC--;
+		F = (F & FLAG_C) | FLAG_N;
+		F |= (A ^ tmp ^ stmp) & FLAG_H;
+		F |= (BC ? FLAG_P : 0);
+		F |= stmp & FLAG_S;
+		F |= (stmp == 0) ? FLAG_Z : 0;
+		stmp -= (F >> 4) & 1;
+		BLOCKXY(stmp);
+		CYCLES += 16;
+		break;
+	case 0xA3:	//outi
+		B--;
+		z80->iowritefunc(BC, read8(HL++));
+		CYCLES += 16;
+		break;
+	case 0xA8:	//ldd
+		stmp = read8(HL--);
+		write8(DE--, stmp);
+		F &= (FLAG_S | FLAG_Z | FLAG_C);
+		F |= --BC ? FLAG_P : 0;
+		stmp += A;
+		BLOCKXY(stmp);
+		CYCLES += 16;
+		break;
+
+	case 0xA9:	//cpd
+		tmp = read8(HL--);
+		stmp = A - tmp;
+		BC--;
+		F = (F & FLAG_C) | FLAG_N;
+		F |= (A ^ tmp ^ stmp) & FLAG_H;
+		F |= (BC ? FLAG_P : 0);
+		F |= stmp & FLAG_S;
+		F |= (stmp == 0) ? FLAG_Z : 0;
+		stmp -= (F >> 4) & 1;
+		BLOCKXY(stmp);
+		CYCLES += 16;
+		break;
+
+	case 0xB0:	//ldir
+		tmp = read8(HL);
+		write8(DE, tmp);
+		DE++;
+		HL++;
+		BC--;
+		if (BC != 0) {
+			PC -= 2;
+			CYCLES += 21;
+			F &= ~(FLAG_N | FLAG_H | FLAGS_XY);
+			F |= FLAG_P;
+		}
+		else {
+			F &= ~(FLAG_H | FLAG_P | FLAG_N | FLAGS_XY);
+			CYCLES += 16;
+		}
+		//	printf("ldir done: PC = $%04X\n",PC);
+		tmp += A;
+		BLOCKXY(tmp);
+		break;
+	case 0xB1:	//cpir
+		tmp = read8(HL++);
+		stmp = A - tmp;
+		if (--BC && stmp) {
+			CYCLES += 21;
+			PC -= 2;
+		}
+		else {
+			CYCLES += 16;
+		}
+
+		F = (F & FLAG_C) | FLAG_N;
+		F |= (A ^ tmp ^ stmp) & FLAG_H;
+		F |= (BC ? FLAG_P : 0);
+		F |= stmp & FLAG_S;
+		F |= (stmp == 0) ? FLAG_Z : 0;
+
+		//calculate the x and y flags
+		stmp -= (F >> 4) & 1;
+		BLOCKXY(stmp);
+		break;
+
+	case 0xB3:	//otir
+		B--;
+		z80->iowritefunc(BC, read8(HL++));
+		PC -= 2;
+		break;
+
+	case 0xB8:	//lddr
+		stmp = read8(HL--);
+		write8(DE--, stmp);
+		F &= (FLAG_S | FLAG_Z | FLAG_C);
+		F |= --BC ? FLAG_P : 0;
+		stmp += A;
+		BLOCKXY(stmp);
+		if (BC > 0) {
+			CYCLES += 21;
+			PC -= 2;
+		}
+		else {
+			CYCLES += 16;
+		}
+		break;
+
+	case 0xB9:	//cpdr
+		tmp = read8(HL--);
+		stmp = A - tmp;
+		if (--BC && stmp) {
+			PC -= 2;
+			CYCLES += 21;
+		}
+		else {
+			CYCLES += 16;
+		}
+
+		F = (F & FLAG_C) | FLAG_N;
+		F |= (A ^ tmp ^ stmp) & FLAG_H;
+		F |= (BC ? FLAG_P : 0);
+		F |= stmp & FLAG_S;
+		F |= (stmp == 0) ? FLAG_Z : 0;
+
+		//calculate the x and y flags
+		stmp -= (F >> 4) & 1;
+		BLOCKXY(stmp);
+		break;
+
+	default:
+		printf("bad ED opcode $%02X\n", opcode);
+		break;
+	}
+}
+
+__inline void CORE(step_fdcb)()
+{
+	unsigned char data = read8(PC++);
+	unsigned char opcode = read8(PC++);
+	unsigned short stmp, tmp16;
+	unsigned char tmp, tmp2;
+	unsigned long ltmp;
+
+	ltmp = (unsigned int)(unsigned short)((signed short)IY + (signed char)data);	\
+		switch (opcode) {
+		case 0x06: tmp2 = read8(ltmp); RLC(tmp2); write8(ltmp, tmp2); CYCLES += 23; break; //rlc (ix+n)
+		case 0x0E: tmp2 = read8(ltmp); RRC(tmp2); write8(ltmp, tmp2); CYCLES += 23; break; //rrc (ix+n)
+		case 0x16: tmp2 = read8(ltmp); RL(tmp2);  write8(ltmp, tmp2); CYCLES += 23; break; //rl (ix+n)
+		case 0x1E: tmp2 = read8(ltmp); RR(tmp2);  write8(ltmp, tmp2); CYCLES += 23; break; //rr (ix+n)
+		case 0x26: tmp2 = read8(ltmp); SLA(tmp2); write8(ltmp, tmp2); CYCLES += 23; break; //sla (ix+n)
+		case 0x2E: tmp2 = read8(ltmp); SRA(tmp2); write8(ltmp, tmp2); CYCLES += 23; break; //sra (ix+n)
+		case 0x36: tmp2 = read8(ltmp); SLL(tmp2); write8(ltmp, tmp2); CYCLES += 23; break; //sla (ix+n)
+		case 0x3E: tmp2 = read8(ltmp); SRL(tmp2); write8(ltmp, tmp2); CYCLES += 23; break; //sra (ix+n)
+		case 0x40:
+		case 0x41:
+		case 0x42:
+		case 0x43:
+		case 0x44:
+		case 0x45:
+		case 0x46:	//bit 0,(ix+n)
+		case 0x47:	BIT_IDX(0);							break;
+		case 0x48:
+		case 0x49:
+		case 0x4A:
+		case 0x4B:
+		case 0x4C:
+		case 0x4D:
+		case 0x4E:	//bit 1,(ix+n)
+		case 0x4F:	BIT_IDX(1);							break;
+		case 0x50:
+		case 0x51:
+		case 0x52:
+		case 0x53:
+		case 0x54:
+		case 0x55:
+		case 0x56:	//bit 2,(ix+n)
+		case 0x57:	BIT_IDX(2);							break;
+		case 0x58:
+		case 0x59:
+		case 0x5A:
+		case 0x5B:
+		case 0x5C:
+		case 0x5D:
+		case 0x5E:	//bit 3,(ix+n)
+		case 0x5F:	BIT_IDX(3);							break;
+		case 0x60:
+		case 0x61:
+		case 0x62:
+		case 0x63:
+		case 0x64:
+		case 0x65:
+		case 0x66:	//bit 4,(ix+n)
+		case 0x67:	BIT_IDX(4);							break;
+		case 0x68:
+		case 0x69:
+		case 0x6A:
+		case 0x6B:
+		case 0x6C:
+		case 0x6D:
+		case 0x6E:	//bit 5,(ix+n)
+		case 0x6F:	BIT_IDX(5);							break;
+		case 0x70:
+		case 0x71:
+		case 0x72:
+		case 0x73:
+		case 0x74:
+		case 0x75:
+		case 0x76:	//bit 6,(ix+n)
+		case 0x77:	BIT_IDX(6);							break;
+		case 0x78:
+		case 0x79:
+		case 0x7A:
+		case 0x7B:
+		case 0x7C:
+		case 0x7D:
+		case 0x7E:	//bit 7,(ix+n)
+		case 0x7F:	BIT_IDX(7);							break;
+		case 0x80:
+		case 0x81:
+		case 0x82:
+		case 0x83:
+		case 0x84:
+		case 0x85:
+		case 0x86:	//res 0,(ix+n)
+		case 0x87:	RES_IDX(0);							break;
+		case 0x88:
+		case 0x89:
+		case 0x8A:
+		case 0x8B:
+		case 0x8C:
+		case 0x8D:
+		case 0x8E:	//res 1,(ix+n)
+		case 0x8F:	RES_IDX(1);							break;
+		case 0x90:
+		case 0x91:
+		case 0x92:
+		case 0x93:
+		case 0x94:
+		case 0x95:
+		case 0x96:	//res 2,(ix+n)
+		case 0x97:	RES_IDX(2);							break;
+		case 0x98:
+		case 0x99:
+		case 0x9A:
+		case 0x9B:
+		case 0x9C:
+		case 0x9D:
+		case 0x9E:	//res 3,(ix+n)
+		case 0x9F:	RES_IDX(3);							break;
+		case 0xA0:
+		case 0xA1:
+		case 0xA2:
+		case 0xA3:
+		case 0xA4:
+		case 0xA5:
+		case 0xA6:	//res 4,(ix+n)
+		case 0xA7:	RES_IDX(4);							break;
+		case 0xA8:
+		case 0xA9:
+		case 0xAA:
+		case 0xAB:
+		case 0xAC:
+		case 0xAD:
+		case 0xAE:	//res 5,(ix+n)
+		case 0xAF:	RES_IDX(5);							break;
+		case 0xB0:
+		case 0xB1:
+		case 0xB2:
+		case 0xB3:
+		case 0xB4:
+		case 0xB5:
+		case 0xB6:	//res 6,(ix+n)
+		case 0xB7:	RES_IDX(6);							break;
+		case 0xB8:
+		case 0xB9:
+		case 0xBA:
+		case 0xBB:
+		case 0xBC:
+		case 0xBD:
+		case 0xBE:	//res 7,(ix+n)
+		case 0xBF:	RES_IDX(7);							break;
+		case 0xC0:
+		case 0xC1:
+		case 0xC2:
+		case 0xC3:
+		case 0xC4:
+		case 0xC5:
+		case 0xC6:	//set 0,(ix+n)
+		case 0xC7:	SET_IDX(0);							break;
+		case 0xC8:
+		case 0xC9:
+		case 0xCA:
+		case 0xCB:
+		case 0xCC:
+		case 0xCD:
+		case 0xCE:	//set 1,(ix+n)
+		case 0xCF:	SET_IDX(1);							break;
+		case 0xD0:
+		case 0xD1:
+		case 0xD2:
+		case 0xD3:
+		case 0xD4:
+		case 0xD5:
+		case 0xD6:	//set 2,(ix+n)
+		case 0xD7:	SET_IDX(2);							break;
+		case 0xD8:
+		case 0xD9:
+		case 0xDA:
+		case 0xDB:
+		case 0xDC:
+		case 0xDD:
+		case 0xDE:	//set 3,(ix+n)
+		case 0xDF:	SET_IDX(3);							break;
+		case 0xE0:
+		case 0xE1:
+		case 0xE2:
+		case 0xE3:
+		case 0xE4:
+		case 0xE5:
+		case 0xE6:	//set 4,(ix+n)
+		case 0xE7:	SET_IDX(4);							break;
+		case 0xE8:
+		case 0xE9:
+		case 0xEA:
+		case 0xEB:
+		case 0xEC:
+		case 0xED:
+		case 0xEE:	//set 5,(ix+n)
+		case 0xEF:	SET_IDX(5);							break;
+		case 0xF0:
+		case 0xF1:
+		case 0xF2:
+		case 0xF3:
+		case 0xF4:
+		case 0xF5:
+		case 0xF6:	//set 6,(ix+n)
+		case 0xF7:	SET_IDX(6);							break;
+		case 0xF8:
+		case 0xF9:
+		case 0xFA:
+		case 0xFB:
+		case 0xFC:
+		case 0xFD:
+		case 0xFE:	//set 7,(ix+n)
+		case 0xFF:	SET_IDX(7);							break;
+
+		default:
+			printf("bad DDCB opcode = $%02X\n", opcode);
+			break;
+	}
+}
+
+__inline void CORE(step_fd)()
+{
+	unsigned char opcode = read8(PC++);
+	unsigned short stmp, tmp16;
+	unsigned char tmp;
+	unsigned long ltmp, otmp;
+
+	M1++;
+
+	switch (opcode) {
+	case 0x09:	ADD16(IY, BC);	CYCLES += 8;	break;
+	case 0x19:	ADD16(IY, DE);	CYCLES += 8;	break;
+	case 0x21:	//ld IY,nn
+		IY = read16(PC);
+		PC += 2;
+		CYCLES += 14;
+		break;
+	case 0x22:	//ld (nn),IY
+		write16(read16(PC), IY);
+		PC += 2;
+		CYCLES += 20;
+		break;
+	case 0x23:	//inc IY
+		IY++;
+		CYCLES += 10;
+		break;
+	case 0x24:	//inc iyh
+		IY = ((IY + 0x100) & 0xFF00) | (IY & 0xFF);
+		CYCLES += 10;
+		break;
+	case 0x25:	//dec iyh
+		IY = ((IY - 0x100) & 0xFF00) | (IY & 0xFF);
+		CYCLES += 10;
+		break;
+
+	case 0x26:	//ld iyh,n
+		IY = (read8(PC++) << 8) | (IY & 0xFF);
+		CYCLES += 11;
+		break;
+	case 0x29:	ADD16(IY, IY);	CYCLES += 8;	break;
+	case 0x2A:	//ld IY,(nn)
+		IY = read16(read16(PC));
+		PC += 2;
+		CYCLES += 20;
+		break;
+	case 0x2B:	//dec IY
+		IY--;
+		CYCLES += 10;
+		break;
+	case 0x2C:	//inc iyl
+		IY = ((IY & 0xFF00) | ((IY + 1) & 0xFF));
+		IY += 0x100;
+		CYCLES += 10;
+		break;
+	case 0x2D:	//dec iyl
+		IY = ((IY & 0xFF00) | ((IY - 1) & 0xFF));
+		CYCLES += 10;
+		break;
+
+	case 0x2E:	//ld iyl,n
+		IY = read8(PC++) | (IY & 0xFF00);
+		CYCLES += 11;
+		break;
+
+	case 0x34:	//inc (IY+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		tmp = read8(ltmp);
+		INC(tmp);
+		write8(ltmp, tmp);
+		CYCLES += 23;
+		break;
+	case 0x35:	//dec (IY+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		tmp = read8(ltmp);
+		DEC(tmp);
+		write8(ltmp, tmp);
+		CYCLES += 23;
+		break;
+
+	case 0x36:	//ld (IY+d),n
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		write8(ltmp, read8(PC++));
+		CYCLES += 19;
+		break;
+	case 0x39:	ADD16(IY, SP);	CYCLES += 8;	break;
+
+	case 0x40:	B = B;								CYCLES += 8;	break;
+	case 0x41:	B = C;								CYCLES += 8;	break;
+	case 0x42:	B = D;								CYCLES += 8;	break;
+	case 0x43:	B = E;								CYCLES += 8;	break;
+	case 0x44:	B = IYH;							CYCLES += 8;	break;
+	case 0x45:	B = IYL;							CYCLES += 8;	break;
+	case 0x46:	//ld b,(IY+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		B = read8(ltmp);
+		CYCLES += 19;
+		break;
+	case 0x47:	B = A;								CYCLES += 8;	break;
+	case 0x48:	C = B;								CYCLES += 8;	break;
+	case 0x49:	C = C;								CYCLES += 8;	break;
+	case 0x4A:	C = D;								CYCLES += 8;	break;
+	case 0x4B:	C = E;								CYCLES += 8;	break;
+	case 0x4C:	C = IYH;							CYCLES += 8;	break;
+	case 0x4D:	C = IYL;							CYCLES += 8;	break;
+	case 0x4E:	//ld c,(IY+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		C = read8(ltmp);
+		CYCLES += 19;
+		break;
+	case 0x4F:	C = A;								CYCLES += 8;	break;
+	case 0x50:	D = B;								CYCLES += 8;	break;
+	case 0x51:	D = C;								CYCLES += 8;	break;
+	case 0x52:	D = D;								CYCLES += 8;	break;
+	case 0x53:	D = E;								CYCLES += 8;	break;
+	case 0x54:	D = IYH;							CYCLES += 8;	break;
+	case 0x55:	D = IYL;							CYCLES += 8;	break;
+	case 0x56:	//ld d,(IY+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		D = read8(ltmp);
+		CYCLES += 19;
+		break;
+	case 0x57:	D = A;								CYCLES += 8;	break;
+	case 0x58:	E = B;								CYCLES += 8;	break;
+	case 0x59:	E = C;								CYCLES += 8;	break;
+	case 0x5A:	E = D;								CYCLES += 8;	break;
+	case 0x5B:	E = E;								CYCLES += 8;	break;
+	case 0x5C:	E = IYH;							CYCLES += 8;	break;
+	case 0x5D:	E = IYL;							CYCLES += 8;	break;
+	case 0x5E:	//ld e,(IY+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		E = read8(ltmp);
+		CYCLES += 19;
+		break;
+	case 0x5F:	E = A;								CYCLES += 8;	break;
+	case 0x60:	IYH = B;								CYCLES += 8;	break;
+	case 0x61:	IYH = C;								CYCLES += 8;	break;
+	case 0x62:	IYH = D;								CYCLES += 8;	break;
+	case 0x63:	IYH = E;								CYCLES += 8;	break;
+	case 0x64:	IYH = IYH;							CYCLES += 8;	break;
+	case 0x65:	IYH = IYL;							CYCLES += 8;	break;
+	case 0x66:	//ld h,(IY+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		H = read8(ltmp);
+		CYCLES += 19;
+		break;
+	case 0x67:	IYH = A;								CYCLES += 8;	break;
+	case 0x68:	IYL = B;								CYCLES += 8;	break;
+	case 0x69:	IYL = C;								CYCLES += 8;	break;
+	case 0x6A:	IYL = D;								CYCLES += 8;	break;
+	case 0x6B:	IYL = E;								CYCLES += 8;	break;
+	case 0x6C:	IYL = IYH;							CYCLES += 8;	break;
+	case 0x6D:	IYL = IYL;							CYCLES += 8;	break;
+	case 0x6E:	//ld l,(IY+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		L = read8(ltmp);
+		CYCLES += 19;
+		break;
+	case 0x6F:	IYL = A;								CYCLES += 8;	break;
+
+	case 0x70:	//ld (IY+d),b
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		write8(ltmp, B);
+		CYCLES += 19;
+		break;
+	case 0x71:	//ld (IY+d),c
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		write8(ltmp, C);
+		CYCLES += 19;
+		break;
+	case 0x72:	//ld (IY+d),d
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		write8(ltmp, D);
+		CYCLES += 19;
+		break;
+	case 0x73:	//ld (IY+d),e
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		write8(ltmp, E);
+		CYCLES += 19;
+		break;
+	case 0x74:	//ld (IY+d),h
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		write8(ltmp, H);
+		CYCLES += 19;
+		break;
+	case 0x75:	//ld (IY+d),l
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		write8(ltmp, L);
+		CYCLES += 19;
+		break;
+	case 0x77:	//ld (IY+d),a
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		write8(ltmp, A);
+		CYCLES += 19;
+		break;
+
+	case 0x78:	A = B;								CYCLES += 8;	break;
+	case 0x79:	A = C;								CYCLES += 8;	break;
+	case 0x7A:	A = D;								CYCLES += 8;	break;
+	case 0x7B:	A = E;								CYCLES += 8;	break;
+	case 0x7C:	A = IYH;							CYCLES += 8;	break;
+	case 0x7D:	A = IYL;							CYCLES += 8;	break;
+	case 0x7E:	//ld a,(IY+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		A = read8(ltmp);
+		CYCLES += 19;
+		break;
+	case 0x7F:	A = A;								CYCLES += 8;	break;
+
+	case 0x84:	ADD(IYH);							CYCLES += 8;	break;
+	case 0x85:	ADD(IYL);							CYCLES += 8;	break;
+	case 0x86:	//add a,(IY+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		ADD(read8(ltmp));
+		CYCLES += 19;
+		break;
+	case 0x8C:	ADC(IYH);							CYCLES += 8;	break;
+	case 0x8D:	ADC(IYL);							CYCLES += 8;	break;
+	case 0x8E:	//adc a,(IY+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		ADC(read8(ltmp));
+		CYCLES += 19;
+		break;
+	case 0x94:	SUB(IYH);							CYCLES += 8;	break;
+	case 0x95:	SUB(IYL);							CYCLES += 8;	break;
+	case 0x96:	//sub a,(IY+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		SUB(read8(ltmp));
+		CYCLES += 19;
+		break;
+	case 0x9C:	SBC(IYH);							CYCLES += 8;	break;
+	case 0x9D:	SBC(IYL);							CYCLES += 8;	break;
+	case 0x9E:	//sbc a,(IY+d)
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		SBC(read8(ltmp));
+		CYCLES += 19;
+		break;
+	case 0xA4:	AND(IYH);							CYCLES += 8;	break;
+	case 0xA5:	AND(IYL);							CYCLES += 8;	break;
+	case 0xA6:
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		tmp = read8(ltmp);
+		AND(tmp);
+		CYCLES += 19;
+		break;
+	case 0xAC:	XOR(IYH);							CYCLES += 8;	break;
+	case 0xAD:	XOR(IYL);							CYCLES += 8;	break;
+	case 0xAE:
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		tmp = read8(ltmp);
+		XOR(tmp);
+		CYCLES += 19;
+		break;
+	case 0xB4:	OR(IYH);							CYCLES += 8;	break;
+	case 0xB5:	OR(IYL);							CYCLES += 8;	break;
+	case 0xB6:
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		tmp = read8(ltmp);
+		OR(tmp);
+		CYCLES += 19;
+		break;
+	case 0xBC:	CP(IYH);							CYCLES += 8;	break;
+	case 0xBD:	CP(IYL);							CYCLES += 8;	break;
+	case 0xBE:
+		ltmp = (unsigned long)(unsigned short)((signed short)IY + (signed char)read8(PC++));
+		tmp = read8(ltmp);
+		CP(tmp);
+		CYCLES += 19;
+		break;
+	case 0xCB:	return(CORE(step_fdcb)());
+	case 0xE1:	//pop IY
+		POP16(IY);
+		CYCLES += 14;
+		break;
+	case 0xE5:	//push IY
+		PUSH16(IY);
+		CYCLES += 15;
+		break;
+
+	default:
+		printf("bad FD opcode $%02X\n", opcode);
+		break;
+	}
+}
+
+static void CORE(step)()
+{
+	register u8 tmp8;
+
+	if (INSIDEIRQ) {
+		OPCODE = z80->irqfunc(IRQSTATE);
+		INSIDEIRQ = 0;
+	}
+	else
+		//fetch opcode from memory
+		OPCODE = read8(PC++);
+
+	//every opcode fetch is an m1 cycle, r is derived from this count
+	M1++;
+
+	//halt
+	if (HALT) {
+		return;
+	}
+
+
+	//find what opcode it is and do what it does
+	switch(OPCODE) {
+
+	case 0x00:	//nop
+		CYCLES += 4;
+		break;
+
+	case 0x01:	//ld bc,nnnn
+		BC = read16(PC);
+		PC += 2;
+		CYCLES += 10;
+		break;
+
+	case 0x02:	//ld (bc),a
+		write8(BC, A);
+		CYCLES += 7;
+		break;
+
+	case 0x03:	INC16(BC);				CYCLES += 6;	break;
+	case 0x04:	INC(B);					CYCLES += 4;	break;
+	case 0x05:	DEC(B);					CYCLES += 4;	break;
+	case 0x06:	B = read8(PC++);		CYCLES += 7;	break;
+
+
+
+
+
+	case 0x07:	//rlca
+		tmp = (A & 0x80) >> 7;
+		A <<= 1;
+		A |= tmp & 1;
+		F &= ~(FLAG_N | FLAG_H | FLAG_C | FLAGS_XY);
+		F |= tmp | (A & FLAGS_XY);
+		CYCLES += 4;
+		break;
+
+	case 0x08:	//ex af,af'
+		utmp[0] = z80->main.af.w;
+		z80->main.af.w = z80->alt.af.w;
+		z80->alt.af.w = utmp[0];
+		CYCLES += 4;
+		break;
+
+	case 0x09:	//add hl,bc
+		ADD16(HL, BC);
+		CYCLES += 4;
+		break;
+
+	case 0x0A:	//ld a,(bc)
+		A = read8(BC);
+		CYCLES += 7;
+		break;
+
+	case 0x0B:	DEC16(BC);				CYCLES += 6;	break;
+	case 0x0C:	INC(C);					CYCLES += 4;	break;
+	case 0x0D:	DEC(C);					CYCLES += 4;	break;
+	case 0x0E:	C = read8(PC++);		CYCLES += 7;	break;
+
+	case 0x0F:	//rrca
+		F = (F & (FLAG_P | FLAG_Z | FLAG_S)) | (A & 1);
+		A = (A >> 1) | ((A << 7) & 0x80);
+		F |= A & FLAGS_XY;
+		CYCLES += 4;
+		break;
+
+	case 0x10:	//djnz imm8
+		stmp = (signed char)read8(PC++) + PC;
+		if (--B > 0) {
+			PC = stmp;
+			CYCLES += 13;
+		}
+		else
+			CYCLES += 8;
+		break;
+
+	case 0x11:	//ld de,imm16
+		DE = read16(PC);
+		PC += 2;
+		CYCLES += 10;
+		break;
+
+	case 0x12:	//ld (de),a
+		write8(DE, A);
+		CYCLES += 7;
+		break;
+
+	case 0x13:	INC16(DE);				CYCLES += 6;	break;
+	case 0x14:	INC(D);					CYCLES += 4;	break;
+	case 0x15:	DEC(D);					CYCLES += 4;	break;
+	case 0x16:	D = read8(PC++);		CYCLES += 7;	break;
+	case 0x17:	RLA();					CYCLES += 4;	break;
+
+	case 0x18:	//jr simm8
+		stmp = (signed char)read8(PC++) + PC;
+		PC = stmp;
+		CYCLES += 13;
+		break;
+
+	case 0x19:	//add hl,de
+		ADD16(HL, DE);
+		CYCLES += 4;
+		break;
+
+	case 0x1A:	A = read8(DE);	CYCLES += 7;	break;
+	case 0x1B:	DEC16(DE);				CYCLES += 6;	break;
+	case 0x1C:	INC(E);					CYCLES += 4;	break;
+	case 0x1D:	DEC(E);					CYCLES += 4;	break;
+	case 0x1E:	E = read8(PC++);	CYCLES += 7;	break;
+
+	case 0x1F:	//rra
+		tmp = A & 1;
+		A >>= 1;
+		A |= (F << 7) & 0x80;
+		F &= ~(FLAG_N | FLAG_H | FLAG_C | FLAGS_XY);
+		F |= tmp | (A & FLAGS_XY);
+		CYCLES += 4;
+		break;
+
+	case 0x20:	//jr nz,simm8
+		stmp = (signed char)read8(PC++) + PC;
+		if ((F & FLAG_Z) == 0) {
+			PC = stmp;
+			CYCLES += 13;
+		}
+		else
+			CYCLES += 8;
+		break;
+
+	case 0x21:	//ld hl,imm16
+		HL = read16(PC);
+		PC += 2;
+		CYCLES += 10;
+		break;
+
+	case 0x22:	//ld (u16),hl
+		write16(read16(PC), HL);
+		PC += 2;
+		CYCLES += 16;
+		break;
+
+	case 0x23:	INC16(HL);				CYCLES += 6;	break;
+	case 0x24:	INC(H);					CYCLES += 4;	break;
+	case 0x25:	DEC(H);					CYCLES += 4;	break;
+	case 0x26:	H = read8(PC++);		CYCLES += 7;	break;
+
+	case 0x27:	//daa
+		//		DAA;
+
+	{
+		int     a, c, d;
+		a = A;
+
+		if (a > 0x99 || (F & FLAG_C)) {
+			c = FLAG_C;
+			d = 0x60;
+		}
+		else
+			c = d = 0;
+
+		if ((a & 0x0f) > 0x09 || (F & FLAG_H))
+			d += 0x06;
+
+		A += (F & FLAG_N) ? -d : +d;
+
+		F = (F & FLAG_N) | (A & FLAGS_XY) | c;
+		F |= (A ^ a) & FLAG_H;
+		if (A == 0)
+			F |= FLAG_Z;
+		if (A & 0x80)
+			F |= FLAG_S;
+		if (parity[A])
+			F |= FLAG_P;
+	}
+		CYCLES += 4;
+		break;
+
+	case 0x28:	//jr z,simm8
+		stmp = (signed char)read8(PC++) + PC;
+		if ((F & FLAG_Z) != 0) {
+			PC = stmp;
+			CYCLES += 13;
+		}
+		else
+			CYCLES += 8;
+		break;
+
+	case 0x29:	ADD16(HL, HL);		CYCLES += 4;	break;
+
+	case 0x2A:	//ld hl,(imm16)
+		HL = read16(read16(PC));
+		PC += 2;
+		CYCLES += 16;
+		break;
+
+	case 0x2B:	DEC16(HL);			CYCLES += 6;	break;
+	case 0x2C:	INC(L);				CYCLES += 4;	break;
+	case 0x2D:	DEC(L);				CYCLES += 4;	break;
+	case 0x2E:	L = read8(PC++);	CYCLES += 7;	break;
+
+	case 0x2F:	//cpl
+		A ^= 0xFF;
+		F &= ~(FLAG_N | FLAG_H | FLAGS_XY);
+		F |= FLAG_N | FLAG_H | (A & FLAGS_XY);
+		CYCLES += 4;
+		break;
+
+	case 0x30:	//jr nc,simm8
+		stmp = (signed char)read8(PC++) + PC;
+		if ((F & FLAG_C) == 0) {
+			PC = stmp;
+			CYCLES += 13;
+		}
+		else
+			CYCLES += 8;
+		break;
+
+	case 0x31:	//ld SP,nnnn
+		SP = read16(PC);
+		PC += 2;
+		CYCLES += 10;
+		break;
+
+	case 0x32:	//ld (u16),a
+		write8(read16(PC), A);
+		PC += 2;
+		CYCLES += 13;
+		break;
+
+	case 0x33:	INC16(SP);		CYCLES += 6;		break;
+
+	case 0x34:	//inc (hl)
+		tmp = read8(HL);
+		INC(tmp);
+		write8(HL, tmp);
+		CYCLES += 11;
+		break;
+
+	case 0x35:	//dec (hl)
+		tmp = read8(HL);
+		DEC(tmp);
+		write8(HL, tmp);
+		CYCLES += 11;
+		break;
+
+	case 0x36:	//ld (hl),n
+		write8(HL, read8(PC++));
+		CYCLES += 10;
+		break;
+
+	case 0x37:
+		F &= ~(FLAG_H | FLAG_N | FLAGS_XY);
+		F |= FLAG_C | (A & FLAGS_XY);
+		CYCLES += 4;
+		break;
+
+	case 0x38:	//jr c,simm8
+		stmp = (signed char)read8(PC++) + PC;
+		if ((F & FLAG_C) != 0) {
+			PC = stmp;
+			CYCLES += 13;
+		}
+		else
+			CYCLES += 8;
+		break;
+
+	case 0x39:	//add hl,SP
+		ADD16(HL, SP);
+		CYCLES += 4;
+		break;
+
+	case 0x3A:	//ld a,(nn)
+		A = read8(read16(PC));
+		PC += 2;
+		CYCLES += 13;
+		break;
+
+	case 0x3B:	DEC16(SP);							CYCLES += 6;	break;
+	case 0x3C:	INC(A);								CYCLES += 4;	break;
+	case 0x3D:	DEC(A);								CYCLES += 4;	break;
+	case 0x3E:	A = read8(PC++);					CYCLES += 7;	break;
+
+	case 0x3F:	//ccf
+		tmp = F & FLAG_C;
+		F &= FLAG_V | FLAG_P | FLAG_Z | FLAG_S;
+		F |= (A & FLAGS_XY) | (tmp << 4) | (tmp ^ FLAG_C);
+		CYCLES += 4;
+		break;
+
+	case 0x40:	B = B;								CYCLES += 4;	break;
+	case 0x41:	B = C;								CYCLES += 4;	break;
+	case 0x42:	B = D;								CYCLES += 4;	break;
+	case 0x43:	B = E;								CYCLES += 4;	break;
+	case 0x44:	B = H;								CYCLES += 4;	break;
+	case 0x45:	B = L;								CYCLES += 4;	break;
+	case 0x46:	B = read8(HL);						CYCLES += 7;	break;
+	case 0x47:	B = A;								CYCLES += 4;	break;
+	case 0x48:	C = B;								CYCLES += 4;	break;
+	case 0x49:	C = C;								CYCLES += 4;	break;
+	case 0x4A:	C = D;								CYCLES += 4;	break;
+	case 0x4B:	C = E;								CYCLES += 4;	break;
+	case 0x4C:	C = H;								CYCLES += 4;	break;
+	case 0x4D:	C = L;								CYCLES += 4;	break;
+	case 0x4E:	C = read8(HL);						CYCLES += 7;	break;
+	case 0x4F:	C = A;								CYCLES += 4;	break;
+	case 0x50:	D = B;								CYCLES += 4;	break;
+	case 0x51:	D = C;								CYCLES += 4;	break;
+	case 0x52:	D = D;								CYCLES += 4;	break;
+	case 0x53:	D = E;								CYCLES += 4;	break;
+	case 0x54:	D = H;								CYCLES += 4;	break;
+	case 0x55:	D = L;								CYCLES += 4;	break;
+	case 0x56:	D = read8(HL);						CYCLES += 7;	break;
+	case 0x57:	D = A;								CYCLES += 4;	break;
+	case 0x58:	E = B;								CYCLES += 4;	break;
+	case 0x59:	E = C;								CYCLES += 4;	break;
+	case 0x5A:	E = D;								CYCLES += 4;	break;
+	case 0x5B:	E = E;								CYCLES += 4;	break;
+	case 0x5C:	E = H;								CYCLES += 4;	break;
+	case 0x5D:	E = L;								CYCLES += 4;	break;
+	case 0x5E:	E = read8(HL);						CYCLES += 7;	break;
+	case 0x5F:	E = A;								CYCLES += 4;	break;
+	case 0x60:	H = B;								CYCLES += 4;	break;
+	case 0x61:	H = C;								CYCLES += 4;	break;
+	case 0x62:	H = D;								CYCLES += 4;	break;
+	case 0x63:	H = E;								CYCLES += 4;	break;
+	case 0x64:	H = H;								CYCLES += 4;	break;
+	case 0x65:	H = L;								CYCLES += 4;	break;
+	case 0x66:	H = read8(HL);						CYCLES += 7;	break;
+	case 0x67:	H = A;								CYCLES += 4;	break;
+	case 0x68:	L = B;								CYCLES += 4;	break;
+	case 0x69:	L = C;								CYCLES += 4;	break;
+	case 0x6A:	L = D;								CYCLES += 4;	break;
+	case 0x6B:	L = E;								CYCLES += 4;	break;
+	case 0x6C:	L = H;								CYCLES += 4;	break;
+	case 0x6D:	L = L;								CYCLES += 4;	break;
+	case 0x6E:	L = read8(HL);						CYCLES += 7;	break;
+	case 0x6F:	L = A;								CYCLES += 4;	break;
+	case 0x70:	write8(HL, B);						CYCLES += 7;	break;
+	case 0x71:	write8(HL, C);						CYCLES += 7;	break;
+	case 0x72:	write8(HL, D);						CYCLES += 7;	break;
+	case 0x73:	write8(HL, E);						CYCLES += 7;	break;
+	case 0x74:	write8(HL, H);						CYCLES += 7;	break;
+	case 0x75:	write8(HL, L);						CYCLES += 7;	break;
+	case 0x76:	HALT = 1;	PC--;					CYCLES += 2;	break;
+	case 0x77:	write8(HL, A);						CYCLES += 7;	break;
+	case 0x78:	A = B;								CYCLES += 4;	break;
+	case 0x79:	A = C;								CYCLES += 4;	break;
+	case 0x7A:	A = D;								CYCLES += 4;	break;
+	case 0x7B:	A = E;								CYCLES += 4;	break;
+	case 0x7C:	A = H;								CYCLES += 4;	break;
+	case 0x7D:	A = L;								CYCLES += 4;	break;
+	case 0x7E:	A = read8(HL);						CYCLES += 7;	break;
+	case 0x7F:	A = A;								CYCLES += 4;	break;
+	case 0x80:	ADD(B);								CYCLES += 4;	break;
+	case 0x81:	ADD(C);								CYCLES += 4;	break;
+	case 0x82:	ADD(D);								CYCLES += 4;	break;
+	case 0x83:	ADD(E);								CYCLES += 4;	break;
+	case 0x84:	ADD(H);								CYCLES += 4;	break;
+	case 0x85:	ADD(L);								CYCLES += 4;	break;
+	case 0x86:	tmp = read8(HL); ADD(tmp);		CYCLES += 7;	break;
+	case 0x87:	ADD(A);								CYCLES += 4;	break;
+	case 0x88:	ADC(B);								CYCLES += 4;	break;
+	case 0x89:	ADC(C);								CYCLES += 4;	break;
+	case 0x8A:	ADC(D);								CYCLES += 4;	break;
+	case 0x8B:	ADC(E);								CYCLES += 4;	break;
+	case 0x8C:	ADC(H);								CYCLES += 4;	break;
+	case 0x8D:	ADC(L);								CYCLES += 4;	break;
+	case 0x8E:	tmp = read8(HL); ADC(tmp);		CYCLES += 7;	break;
+	case 0x8F:	ADC(A);								CYCLES += 4;	break;
+	case 0x90:	SUB(B);								CYCLES += 4;	break;
+	case 0x91:	SUB(C);								CYCLES += 4;	break;
+	case 0x92:	SUB(D);								CYCLES += 4;	break;
+	case 0x93:	SUB(E);								CYCLES += 4;	break;
+	case 0x94:	SUB(H);								CYCLES += 4;	break;
+	case 0x95:	SUB(L);								CYCLES += 4;	break;
+	case 0x96:	tmp = read8(HL); SUB(tmp);		CYCLES += 7;	break;
+	case 0x97:	SUB(A);								CYCLES += 4;	break;
+	case 0x98:	SBC(B);								CYCLES += 4;	break;
+	case 0x99:	SBC(C);								CYCLES += 4;	break;
+	case 0x9A:	SBC(D);								CYCLES += 4;	break;
+	case 0x9B:	SBC(E);								CYCLES += 4;	break;
+	case 0x9C:	SBC(H);								CYCLES += 4;	break;
+	case 0x9D:	SBC(L);								CYCLES += 4;	break;
+	case 0x9E:	tmp = read8(HL); SBC(tmp);		CYCLES += 7;	break;
+	case 0x9F:	SBC(A);								CYCLES += 4;	break;
+	case 0xA0:	AND(B);								CYCLES += 4;	break;
+	case 0xA1:	AND(C);								CYCLES += 4;	break;
+	case 0xA2:	AND(D);								CYCLES += 4;	break;
+	case 0xA3:	AND(E);								CYCLES += 4;	break;
+	case 0xA4:	AND(H);								CYCLES += 4;	break;
+	case 0xA5:	AND(L);								CYCLES += 4;	break;
+	case 0xA6:	tmp = read8(HL); AND(tmp);		CYCLES += 7;	break;
+	case 0xA7:	AND(A);								CYCLES += 4;	break;
+	case 0xA8:	XOR(B);								CYCLES += 4;	break;
+	case 0xA9:	XOR(C);								CYCLES += 4;	break;
+	case 0xAA:	XOR(D);								CYCLES += 4;	break;
+	case 0xAB:	XOR(E);								CYCLES += 4;	break;
+	case 0xAC:	XOR(H);								CYCLES += 4;	break;
+	case 0xAD:	XOR(L);								CYCLES += 4;	break;
+	case 0xAE:	tmp = read8(HL); XOR(tmp);		CYCLES += 7;	break;
+	case 0xAF:	XOR(A);								CYCLES += 4;	break;
+	case 0xB0:	OR(B);								CYCLES += 4;	break;
+	case 0xB1:	OR(C);								CYCLES += 4;	break;
+	case 0xB2:	OR(D);								CYCLES += 4;	break;
+	case 0xB3:	OR(E);								CYCLES += 4;	break;
+	case 0xB4:	OR(H);								CYCLES += 4;	break;
+	case 0xB5:	OR(L);								CYCLES += 4;	break;
+	case 0xB6:	tmp = read8(HL); OR(tmp);		CYCLES += 7;	break;
+	case 0xB7:	OR(A);								CYCLES += 4;	break;
+	case 0xB8:	CP(B);								CYCLES += 4;	break;
+	case 0xB9:	CP(C);								CYCLES += 4;	break;
+	case 0xBA:	CP(D);								CYCLES += 4;	break;
+	case 0xBB:	CP(E);								CYCLES += 4;	break;
+	case 0xBC:	CP(H);								CYCLES += 4;	break;
+	case 0xBD:	CP(L);								CYCLES += 4;	break;
+	case 0xBE:	tmp = read8(HL); CP(tmp);		CYCLES += 7;	break;
+	case 0xBF:	CP(A);								CYCLES += 4;	break;
+	case 0xC0:	RET((F & FLAG_Z) == 0);								break;
+	case 0xC1:	POP16(BC);							CYCLES += 10;	break;
+	case 0xC2:	JR((F & FLAG_Z) == 0);								break;
+	case 0xC3:	JP(read16(PC));					CYCLES += 0;	break;
+	case 0xC4:	CALL((F & FLAG_Z) == 0);							break;
+	case 0xC5:	PUSH16(BC);							CYCLES += 11;	break;
+	case 0xC6:	tmp = read8(PC++); ADD(tmp);	CYCLES += 7;	break;
+	case 0xC7:	RST(0x00);												break;
+	case 0xC8:	RET((F & FLAG_Z) != 0);								break;
+	case 0xC9:	RET(1);	CYCLES -= 1;								break;
+	case 0xCA:	JR((F & FLAG_Z) != 0);								break;
+	case 0xCB:	CORE(step_cb)();												break;
+	case 0xCC:	CALL((F & FLAG_Z) != 0);							break;
+	case 0xCD:	CALL(1);													break;
+	case 0xCE:	tmp = read8(PC++); ADC(tmp);	CYCLES += 7;	break;
+	case 0xCF:	RST(0x08);												break;
+	case 0xD0:	RET((F & FLAG_C) == 0);								break;
+	case 0xD1:	POP16(DE);							CYCLES += 10;	break;
+	case 0xD2:	JR((F & FLAG_C) == 0);								break;
+	case 0xD3:	
+		tmp = read8(PC++); 
+		OP_OUT(tmp, A, A);
+		CYCLES += 11;
+		break;
+	case 0xD4:	CALL((F & FLAG_C) == 0);							break;
+	case 0xD5:	PUSH16(DE);							CYCLES += 11;	break;
+	case 0xD6:	SUB(read8(PC++));					CYCLES += 7;	break;
+	case 0xD7:	RST(0x10);												break;
+	case 0xD8:	RET((F & FLAG_C) != 0);								break;
+	case 0xD9:	EXX();													break;
+	case 0xDA:	JR((F & FLAG_C) != 0);								break;
+	case 0xDB:	//in a,(n)
+		tmp8 = deadz80_memread(PC++);
+		A = deadz80_ioread(tmp8 | (A << 8));
+		CYCLES += 11;
+		break;
+	case 0xDC:	CALL((F & FLAG_C) != 0);							break;
+	case 0xDD:	CORE(step_dd)();												break;
+	case 0xDE:	tmp2 = read8(PC++); SBC(tmp2); CYCLES += 7;	break;
+	case 0xDF:	RST(0x18);												break;
+	case 0xE0:	RET((F & FLAG_P) == 0);								break;
+	case 0xE1:	POP16(HL);							CYCLES += 10;	break;
+	case 0xE2:	JR((F & FLAG_P) == 0);								break;
+
+	case 0xE4:	CALL((F & FLAG_P) == 0);							break;
+	case 0xE5:	PUSH16(HL);							CYCLES += 11;	break;
+	case 0xE6:	AND(read8(PC++));					CYCLES += 7;	break;
+	case 0xE7:	RST(0x20);												break;
+	case 0xE8:	RET((F & FLAG_P) != 0);								break;
+	case 0xE9:	JP(HL);													break;
+	case 0xEA:	JR((F & FLAG_P) != 0);								break;
+	case 0xEB:	EX(DE, HL);												break;
+	case 0xEC:	CALL((F & FLAG_P) != 0);							break;
+	case 0xED:	CORE(step_ed)();												break;
+	case 0xEE:	XOR(read8(PC++));					CYCLES += 7;	break;
+	case 0xEF:	RST(0x28);												break;
+	case 0xF0:	RET((F & FLAG_S) == 0);								break;
+	case 0xF1:	POP16(AF);							CYCLES += 10;	break;
+	case 0xF2:	JR((F & FLAG_S) == 0);								break;
+	case 0xF3:	IFF1 = IFF2 = 0;					CYCLES += 4;	break;
+	case 0xF4:	CALL((F & FLAG_S) == 0);							break;
+	case 0xF5:	PUSH16(AF);							CYCLES += 11;	break;
+	case 0xF6:	OR(read8(PC++));					CYCLES += 7;	break;
+	case 0xF7:	RST(0x30);												break;
+	case 0xF8:	RET((F & FLAG_S) != 0);								break;
+	case 0xF9:	SP = HL;								CYCLES += 6;	break;
+	case 0xFA:	JR((F & FLAG_S) != 0);								break;
+	case 0xFB:	IFF1 = IFF2 = 1;					CYCLES += 4;	break;
+	case 0xFC:	CALL((F & FLAG_S) != 0);							break;
+	case 0xFD:	CORE(step_fd)();												break;
+	case 0xFE:	tmp = read8(PC++); CP(tmp);	CYCLES += 7;	break;
+	case 0xFF:	RST(0x38);												break;
+
+	default:	//bad oPCode
+		printf("bad opcode = $%02X\n", OPCODE);
+		return;
+
+	}
+}
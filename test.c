@@ -1,7 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include "deadz80.h"
+#include "profile.h"
+#include "trace.h"
 #include "z80emu/z80emu.h"
 
 #define MAXIMUM_STRING_LENGTH   100
@@ -9,19 +12,24 @@
 u8 mem[0x10000];
 u8 mem2[0x10000];
 deadz80_t *z80;
+int finished = 0;
+int quiet = 0;
 
 static u8 ioread(u32 addr)
 {
 //	printf("ioread $%04X\n", addr);
 
-	if (z80->regs->bc.b.c == 2) {
-		printf("%c", z80->regs->de.b.e);
+	if (finished || quiet)
+		return(0);
+
+	if (z80->main.bc.b.c == 2) {
+		printf("%c", z80->main.de.b.e);
 	}
 
-	else if (z80->regs->bc.b.c == 9) {
+	else if (z80->main.bc.b.c == 9) {
 		int i, c;
 
-		for (i = z80->regs->de.w, c = 0; mem[i] != '$'; i++) {
+		for (i = z80->main.de.w, c = 0; mem[i] != '$'; i++) {
 			printf("%c", mem[i & 0xffff]);
 			if (c++ > MAXIMUM_STRING_LENGTH) {
 
@@ -42,15 +50,66 @@ static void iowrite(u32 addr, u8 data)
 {
 //	printf("iowrite $%04X = $%02X\n", addr, data);
 
+	//the out at address 0 is the cp/m warm boot trap
+	if (z80->pc == 2)
+		finished = 1;
 }
 
 extern unsigned char memory[];
 
 int test2(void);
 
+//run deadz80 alone (no z80emu lockstep) and report the emulation speed.
+//with more than one instance each gets a private copy of memory and they
+//are run round robin in short slices, like a host driving many machines.
+int bench(u32 maxcycles, int instances)
+{
+	clock_t start, end;
+	double total = 0.0, secs;
+	deadz80_t **ctx;
+	u32 slice = 4000000 / 50;
+	int n, i;
+
+	ctx = (deadz80_t**)malloc(sizeof(deadz80_t*) * instances);
+	ctx[0] = z80;
+	for (n = 1; n < instances; n++) {
+		u8 *ram = (u8*)malloc(0x10000);
+
+		memcpy(ram, mem, 0x10000);
+		ctx[n] = deadz80_new();
+		*ctx[n] = *z80;
+		for (i = 0; i < 16; i++) {
+			ctx[n]->readpages[i].ptr = ram + (0x1000 * i);
+			ctx[n]->writepages[i].ptr = ram + (0x1000 * i);
+		}
+	}
+	if (instances > 1) {
+		quiet = 1;
+		slice = 1000;
+		if (maxcycles == 0)
+			maxcycles = 2000000000;
+	}
+
+	start = clock();
+	while (finished == 0 && z80->halt == 0) {
+		for (n = 0; n < instances; n++) {
+			deadz80_setcontext(ctx[n]);
+			z80 = ctx[n];
+			total += deadz80_execute(slice);
+		}
+		if (maxcycles && total >= maxcycles)
+			break;
+	}
+	end = clock();
+	secs = (double)(end - start) / CLOCKS_PER_SEC;
+	printf("\nbench: %d instance(s), %.0f cycles in %.2f seconds (%.2f MHz)\n", instances, total, secs, secs > 0.0 ? total / secs / 1000000.0 : 0.0);
+	return(0);
+}
+
 int state_save(char *filename)
 {
 	FILE *fp;
+	u8 r = deadz80_get_r();
 
 	if ((fp = fopen(filename, "wb")) == 0) {
 		printf("error opening\n");
@@ -75,6 +134,8 @@ int state_save(char *filename)
 	write_u16(z80->ix.w, fp);
 	write_u16(z80->iy.w, fp);
 	write_u32(z80->cycles, fp);
+	write_u8(z80->i, fp);
+	write_u8(r, fp);
 	fwrite(mem, 0x10000, 1, fp);
 	fclose(fp);
 	return(0);
@@ -83,6 +144,7 @@ int state_save(char *filename)
 int state_load(char *filename)
 {
 	FILE *fp;
+	u8 r;
 
 	if ((fp = fopen(filename, "rb")) == 0) {
 		printf("error opening\n");
@@ -102,6 +164,9 @@ int state_load(char *filename)
 	read_u16(z80->ix.w, fp);
 	read_u16(z80->iy.w, fp);
 	read_u32(z80->cycles, fp);
+	read_u8(z80->i, fp);
+	read_u8(r, fp);
+	deadz80_set_r(r);
 	fread(mem, 0x10000, 1, fp);
 
 	fclose(fp);
@@ -118,15 +183,35 @@ int main(int argc, char *argv[])
 	Z80_STATE       state;
 	long total = 0;
 	int c,statecycles = 0;
+	int benchmode = 0, docflags = 0, instances = 1;
+	u32 maxcycles = 0;
+	char *profilename = 0;
+	u32 tracedepth = 0;
 
 //	test2();
 
-	if (argc < 2) {
-		printf("usage: %s test.rom\n",argv[0]);
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-bench") == 0)
+			benchmode = 1;
+		else if (strcmp(argv[i], "-doc") == 0)
+			docflags = 1;
+		else if (strcmp(argv[i], "-cycles") == 0 && i + 1 < argc)
+			maxcycles = strtoul(argv[++i], 0, 0);
+		else if (strcmp(argv[i], "-instances") == 0 && i + 1 < argc)
+			instances = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-profile") == 0 && i + 1 < argc)
+			profilename = argv[++i];
+		else if (strcmp(argv[i], "-trace") == 0 && i + 1 < argc)
+			tracedepth = strtoul(argv[++i], 0, 0);
+		else
+			filename = argv[i];
+	}
+
+	if (filename == 0) {
+		printf("usage: %s [-bench] [-doc] [-cycles n] [-instances n] [-profile out.folded] [-trace depth] test.rom\n",argv[0]);
 		return(1);
 	}
 
-	filename = argv[1];
 	printf("loading file %s\n", filename);
 
 	//try to open the file
@@ -159,17 +244,50 @@ int main(int argc, char *argv[])
 	z80 = deadz80_getcontext();
 
 	for (i = 0; i < 16; i++) {
-		z80->readpages[i] = (u8*)mem + (0x1000 * i);
-		z80->writepages[i] = (u8*)mem + (0x1000 * i);
+		z80->readpages[i].ptr = (u8*)mem + (0x1000 * i);
+		z80->writepages[i].ptr = (u8*)mem + (0x1000 * i);
 	}
 	z80->ioreadfunc = ioread;
 	z80->iowritefunc = iowrite;
 
 	deadz80_reset();
 	z80->pc = 0x100;
+	z80->docflags = docflags;
+
+	//z80emu always computes the x/y flags, so the lockstep comparison
+	//cannot be used with them turned off.  zexdoc still checks the rest.
+	//keep the last instructions in the trace ring and dump them at the end
+	if (tracedepth) {
+		z80tracesnap_t *snap;
+
+		z80->trace = deadz80_trace_create(tracedepth);
+		bench(maxcycles, 1);
+		snap = deadz80_trace_snapshot(z80->trace);
+		deadz80_trace_decode(snap, stdout);
+		deadz80_trace_free(snap);
+		deadz80_trace_destroy(z80->trace);
+		return(0);
+	}
+
+	if (benchmode || docflags)
+		return(bench(maxcycles, instances < 1 ? 1 : instances));
+
+	//profile the first instance, functions to stdout and folded stacks to a file
+	if (profilename) {
+		z80->profile = deadz80_profile_create();
+		bench(maxcycles, 1);
+		deadz80_profile_write_functions(z80->profile, stdout);
+		if ((fp = fopen(profilename, "w")) != 0) {
+			deadz80_profile_write_folded(z80->profile, fp);
+			fclose(fp);
+		}
+		deadz80_profile_destroy(z80->profile);
+		return(0);
+	}
 
 	Z80Reset(&state);
 	state.pc = 0x100;
+	state.r = 0;
 
 	state.registers.word[4] = z80->ix.w;
 	state.registers.word[5] = z80->iy.w;
@@ -184,6 +302,8 @@ int main(int argc, char *argv[])
 	state.registers.word[5] = z80->iy.w;
 	state.registers.word[6] = z80->sp;
 	state.pc = z80->pc;
+	state.i = z80->i;
+	state.r = deadz80_get_r();
 	memcpy(memory, mem, 0x10000);*/
 
 	for (;;) {
@@ -209,12 +329,13 @@ int main(int argc, char *argv[])
 		if (total != z80->cycles)	{ printf("cycles doesnt match %ld should be %ld\n", z80->cycles, total); error = 1; };
 		if (state.pc != z80->pc)	{ printf("pc doesnt match $%04X should be $%04X\n", z80->pc, state.pc); error = 1; };
 		if (state.registers.word[6] != z80->sp)	{ printf("sp doesnt match $%04X should be $%04X\n", z80->sp, state.registers.word[6]); error = 1; };
-		if (state.registers.word[3] != z80->regs->af.w)	{ printf("af doesnt match $%04X should be $%04X\n", z80->regs->af.w, state.registers.word[3]); error = 1; };
-		if (state.registers.word[0] != z80->regs->bc.w)	{ printf("bc doesnt match $%04X should be $%04X\n", z80->regs->bc.w, state.registers.word[0]); error = 1; };
-		if (state.registers.word[1] != z80->regs->de.w)	{ printf("de doesnt match $%04X should be $%04X\n", z80->regs->de.w, state.registers.word[1]); error = 1; };
-		if (state.registers.word[2] != z80->regs->hl.w)	{ printf("hl doesnt match $%04X should be $%04X\n", z80->regs->hl.w, state.registers.word[2]); error = 1; };
+		if (state.registers.word[3] != z80->main.af.w)	{ printf("af doesnt match $%04X should be $%04X\n", z80->main.af.w, state.registers.word[3]); error = 1; };
+		if (state.registers.word[0] != z80->main.bc.w)	{ printf("bc doesnt match $%04X should be $%04X\n", z80->main.bc.w, state.registers.word[0]); error = 1; };
+		if (state.registers.word[1] != z80->main.de.w)	{ printf("de doesnt match $%04X should be $%04X\n", z80->main.de.w, state.registers.word[1]); error = 1; };
+		if (state.registers.word[2] != z80->main.hl.w)	{ printf("hl doesnt match $%04X should be $%04X\n", z80->main.hl.w, state.registers.word[2]); error = 1; };
 		if (state.registers.word[4] != z80->ix.w)	{ printf("ix doesnt match $%04X should be $%04X\n", z80->ix.w, state.registers.word[4]); error = 1; };
 		if (state.registers.word[5] != z80->iy.w)	{ printf("iy doesnt match $%04X should be $%04X\n", z80->iy.w, state.registers.word[5]); error = 1; };
+		if (state.r != deadz80_get_r())	{ printf("r doesnt match $%02X should be $%02X\n", deadz80_get_r(), state.r); error = 1; };
 		if (memcmp(mem, memory, 0x10000) != 0) {
 			int n;
 
@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+deadz80_trace_t *deadz80_trace_create(u32 depth)
+{
+	deadz80_trace_t *t;
+
+	if (depth == 0)
+		return(0);
+	if ((t = (deadz80_trace_t*)malloc(sizeof(deadz80_trace_t))) == 0)
+		return(0);
+	if ((t->recs = (z80tracerec_t*)malloc(sizeof(z80tracerec_t) * depth)) == 0) {
+		free(t);
+		return(0);
+	}
+	t->depth = depth;
+	deadz80_trace_reset(t);
+	return(t);
+}
+
+void deadz80_trace_destroy(deadz80_trace_t *t)
+{
+	if (t) {
+		free(t->recs);
+		free(t);
+	}
+}
+
+//empty the ring.  base and last start at 0 so the first record carries
+//the full register values.
+void deadz80_trace_reset(deadz80_trace_t *t)
+{
+	t->head = 0;
+	t->count = 0;
+	memset(t->base, 0, sizeof(t->base));
+	memset(t->last, 0, sizeof(t->last));
+}
+
+//claim the next record and fill in what is known before the instruction runs
+z80tracerec_t *deadz80_trace_begin(deadz80_trace_t *t, deadz80_t *z)
+{
+	z80tracerec_t *rec = &t->recs[t->head];
+	u32 pc = z->pc;
+	u8 *ptr;
+	int i;
+
+	//ring is full, fold the record being dropped into the base
+	if (t->count == t->depth) {
+		for (i = 0; i < TRACE_NUMREGS; i++)
+			t->base[i] ^= rec->delta[i];
+	}
+	else
+		t->count++;
+	if (++t->head == t->depth)
+		t->head = 0;
+
+	rec->cycles = z->cycles;
+	rec->pc = (u16)pc;
+	ptr = z->readpages[pc >> Z80_PAGE_SHIFT].ptr;
+	if (ptr && (pc & Z80_PAGE_MASK) <= Z80_PAGE_MASK - 3)
+		memcpy(rec->op, ptr + (pc & Z80_PAGE_MASK), 4);
+	else {
+		for (i = 0; i < 4; i++)
+			rec->op[i] = deadz80_peek((pc + i) & 0xFFFF);
+	}
+	return(rec);
+}
+
+//store the register delta once the instruction has run
+void deadz80_trace_end(deadz80_trace_t *t, deadz80_t *z, z80tracerec_t *rec)
+{
+	u16 regs[TRACE_NUMREGS];
+	int i;
+
+	regs[TRACE_AF] = z->main.af.w;
+	regs[TRACE_BC] = z->main.bc.w;
+	regs[TRACE_DE] = z->main.de.w;
+	regs[TRACE_HL] = z->main.hl.w;
+	regs[TRACE_IX] = z->ix.w;
+	regs[TRACE_IY] = z->iy.w;
+	regs[TRACE_SP] = z->sp;
+	for (i = 0; i < TRACE_NUMREGS; i++) {
+		rec->delta[i] = regs[i] ^ t->last[i];
+		t->last[i] = regs[i];
+	}
+}
+
+//copy the ring out, oldest record first, so it can be decoded later
+//while the machine keeps running
+z80tracesnap_t *deadz80_trace_snapshot(deadz80_trace_t *t)
+{
+	z80tracesnap_t *snap;
+	u32 first, n;
+
+	if ((snap = (z80tracesnap_t*)malloc(sizeof(z80tracesnap_t))) == 0)
+		return(0);
+	if ((snap->recs = (z80tracerec_t*)malloc(sizeof(z80tracerec_t) * (t->count ? t->count : 1))) == 0) {
+		free(snap);
+		return(0);
+	}
+	snap->count = t->count;
+	memcpy(snap->base, t->base, sizeof(snap->base));
+	first = (t->head + t->depth - t->count) % t->depth;
+	n = t->depth - first;
+	if (n > t->count)
+		n = t->count;
+	memcpy(snap->recs, t->recs + first, sizeof(z80tracerec_t) * n);
+	memcpy(snap->recs + n, t->recs, sizeof(z80tracerec_t) * (t->count - n));
+	return(snap);
+}
+
+void deadz80_trace_free(z80tracesnap_t *snap)
+{
+	if (snap) {
+		free(snap->recs);
+		free(snap);
+	}
+}
+
+//write the snapshot as disassembly with the registers after each
+//instruction.  the opcode bytes are disassembled from a scratch context
+//so the machine that was traced is not touched.
+int deadz80_trace_decode(z80tracesnap_t *snap, FILE *fp)
+{
+	deadz80_t *old = deadz80_getcontext(), *tmp;
+	u16 regs[TRACE_NUMREGS];
+	u8 page[Z80_PAGE_MASK + 1];
+	char line[256];
+	u32 n;
+	int i;
+
+	if ((tmp = deadz80_new()) == 0)
+		return(1);
+
+	//every page maps the same buffer, the bytes are placed at pc
+	memset(page, 0, sizeof(page));
+	for (i = 0; i < Z80_NUMPAGES; i++)
+		tmp->readpages[i].ptr = page;
+	memcpy(regs, snap->base, sizeof(regs));
+	deadz80_setcontext(tmp);
+	for (n = 0; n < snap->count; n++) {
+		z80tracerec_t *rec = &snap->recs[n];
+
+		for (i = 0; i < TRACE_NUMREGS; i++)
+			regs[i] ^= rec->delta[i];
+		for (i = 0; i < 4; i++)
+			page[(rec->pc + i) & Z80_PAGE_MASK] = rec->op[i];
+		tmp->main.af.w = regs[TRACE_AF];
+		tmp->main.bc.w = regs[TRACE_BC];
+		tmp->main.de.w = regs[TRACE_DE];
+		tmp->main.hl.w = regs[TRACE_HL];
+		tmp->sp = regs[TRACE_SP];
+		tmp->pc = rec->pc;
+		deadz80_disassemble(line, rec->pc);
+		fprintf(fp, "%10u  %s IX=$%04X IY=$%04X\n", rec->cycles, line, regs[TRACE_IX], regs[TRACE_IY]);
+	}
+	deadz80_setcontext(old);
+	deadz80_delete(tmp);
+	return(0);
+}
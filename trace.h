@@ -0,0 +1,54 @@
+#ifndef __deadz80_trace_h__
+#define __deadz80_trace_h__
+
+#include <stdio.h>
+#include "deadz80.h"
+
+//registers carried by the trace, in delta order
+enum {
+	TRACE_AF = 0, TRACE_BC, TRACE_DE, TRACE_HL, TRACE_IX, TRACE_IY, TRACE_SP,
+	TRACE_NUMREGS
+};
+
+//one executed instruction, 24 bytes.  delta is the xor of the registers
+//after this instruction with the registers after the previous record, so
+//unchanged registers are 0 and the values are rebuilt from a base.
+typedef struct z80tracerec_s {
+	u32			cycles;					//cycle counter before the instruction
+	u16			pc;
+	u8				op[4];					//opcode bytes as fetched
+	u16			delta[TRACE_NUMREGS];
+} z80tracerec_t;
+
+typedef struct deadz80_trace_s {
+	z80tracerec_t	*recs;
+	u32			depth;					//number of records in the ring
+	u32			head;						//next record to write
+	u32			count;					//records in use
+	u16			base[TRACE_NUMREGS];	//registers before the oldest record
+	u16			last[TRACE_NUMREGS];	//registers after the newest record
+} deadz80_trace_t;
+
+//a copy of the ring taken with deadz80_trace_snapshot, oldest record first
+typedef struct z80tracesnap_s {
+	z80tracerec_t	*recs;
+	u32			count;
+	u16			base[TRACE_NUMREGS];
+} z80tracesnap_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+	deadz80_trace_t *deadz80_trace_create(u32 depth);
+	void deadz80_trace_destroy(deadz80_trace_t *t);
+	void deadz80_trace_reset(deadz80_trace_t *t);
+	z80tracerec_t *deadz80_trace_begin(deadz80_trace_t *t, deadz80_t *z);
+	void deadz80_trace_end(deadz80_trace_t *t, deadz80_t *z, z80tracerec_t *rec);
+	z80tracesnap_t *deadz80_trace_snapshot(deadz80_trace_t *t);
+	void deadz80_trace_free(z80tracesnap_t *snap);
+	int deadz80_trace_decode(z80tracesnap_t *snap, FILE *fp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif